@@ -0,0 +1,1272 @@
+#include "benchmark.h"
+#include "compact_list.h"
+#include "concurrent_stack.h"
+#include "custom_list.h"
+#include "mpsc_queue.h"
+#include "node_reclaimer.h"
+#include "sorted_list.h"
+#include "thread_pool.h"
+#include "unrolled_list.h"
+
+#include <array>
+#include <forward_list>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <random>
+#include <sstream>
+#include <thread>
+#include <type_traits>
+
+namespace
+{
+    struct Payload256
+    {
+        std::array<char, 256> bytes{};
+
+        bool operator==(const Payload256& rhs) const noexcept
+        {
+            return bytes == rhs.bytes;
+        }
+
+        bool operator<(const Payload256& rhs) const noexcept
+        {
+            return bytes < rhs.bytes;
+        }
+    };
+
+    template <typename Type>
+    Type MakeValue(size_t i);
+
+    template <>
+    int MakeValue<int>(size_t i)
+    {
+        return static_cast<int>(i * 2654435761u);
+    }
+
+    // Long enough to defeat the small-string optimization, so every element owns heap memory.
+    template <>
+    std::string MakeValue<std::string>(size_t i)
+    {
+        std::string value = "benchmark-value-";
+        value += std::to_string(i);
+        value.resize(32, '#');
+        return value;
+    }
+
+    template <>
+    Payload256 MakeValue<Payload256>(size_t i)
+    {
+        Payload256 value;
+        value.bytes[0] = static_cast<char>(i);
+        value.bytes[255] = static_cast<char>(i >> 8);
+        return value;
+    }
+
+    template <typename Type>
+    size_t Touch(const Type& value);
+
+    template <>
+    size_t Touch<int>(const int& value)
+    {
+        return static_cast<size_t>(value);
+    }
+
+    template <>
+    size_t Touch<std::string>(const std::string& value)
+    {
+        return value.size();
+    }
+
+    template <>
+    size_t Touch<Payload256>(const Payload256& value)
+    {
+        return static_cast<size_t>(value.bytes[0]);
+    }
+
+    template <typename Type>
+    const char* TypeName();
+
+    template <>
+    const char* TypeName<int>()
+    {
+        return "int";
+    }
+
+    template <>
+    const char* TypeName<std::string>()
+    {
+        return "string";
+    }
+
+    template <>
+    const char* TypeName<Payload256>()
+    {
+        return "payload256";
+    }
+
+    // Counts the bytes handed out through it, to report container memory per element.
+    template <typename Type>
+    struct ByteCountingAllocator
+    {
+        using value_type = Type;
+
+        ByteCountingAllocator() = default;
+        explicit ByteCountingAllocator(size_t* bytes) noexcept : bytes_ptr(bytes) {}
+
+        template <typename Other>
+        ByteCountingAllocator(const ByteCountingAllocator<Other>& other) noexcept : bytes_ptr(other.bytes_ptr) {}
+
+        Type* allocate(size_t n)
+        {
+            *bytes_ptr += n * sizeof(Type);
+            return std::allocator<Type>().allocate(n);
+        }
+
+        void deallocate(Type* ptr, size_t n) noexcept
+        {
+            *bytes_ptr -= n * sizeof(Type);
+            std::allocator<Type>().deallocate(ptr, n);
+        }
+
+        template <typename Other>
+        bool operator==(const ByteCountingAllocator<Other>& rhs) const noexcept
+        {
+            return bytes_ptr == rhs.bytes_ptr;
+        }
+
+        template <typename Other>
+        bool operator!=(const ByteCountingAllocator<Other>& rhs) const noexcept
+        {
+            return !(*this == rhs);
+        }
+
+        size_t* bytes_ptr = nullptr;
+    };
+
+    // Counts the calls to allocate, to report allocations per run.
+    template <typename Type>
+    struct AllocationCountingAllocator
+    {
+        using value_type = Type;
+
+        AllocationCountingAllocator() = default;
+        explicit AllocationCountingAllocator(size_t* count) noexcept : count_ptr(count) {}
+
+        template <typename Other>
+        AllocationCountingAllocator(const AllocationCountingAllocator<Other>& other) noexcept : count_ptr(other.count_ptr) {}
+
+        Type* allocate(size_t n)
+        {
+            ++*count_ptr;
+            return std::allocator<Type>().allocate(n);
+        }
+
+        void deallocate(Type* ptr, size_t n) noexcept
+        {
+            std::allocator<Type>().deallocate(ptr, n);
+        }
+
+        template <typename Other>
+        bool operator==(const AllocationCountingAllocator<Other>& rhs) const noexcept
+        {
+            return count_ptr == rhs.count_ptr;
+        }
+
+        template <typename Other>
+        bool operator!=(const AllocationCountingAllocator<Other>& rhs) const noexcept
+        {
+            return !(*this == rhs);
+        }
+
+        size_t* count_ptr = nullptr;
+    };
+
+    template <typename List>
+    struct ContainerName;
+
+    template <typename Type, typename Allocator, typename TailPolicy, typename StatsPolicy, typename InlinePolicy, typename FingerprintPolicy, typename IndexPolicy>
+    struct ContainerName<SingleLinkedList<Type, Allocator, TailPolicy, StatsPolicy, InlinePolicy, FingerprintPolicy, IndexPolicy>>
+    {
+        static constexpr const char* value = "SingleLinkedList";
+    };
+
+    template <typename Type, typename Allocator>
+    struct ContainerName<std::forward_list<Type, Allocator>>
+    {
+        static constexpr const char* value = "std::forward_list";
+    };
+
+    template <typename Type, size_t ChunkCapacity, typename Allocator>
+    struct ContainerName<UnrolledLinkedList<Type, ChunkCapacity, Allocator>>
+    {
+        static constexpr const char* value = "UnrolledLinkedList";
+    };
+
+    template <typename Type, typename Allocator>
+    struct ContainerName<CompactList<Type, Allocator>>
+    {
+        static constexpr const char* value = "CompactList";
+    };
+
+    template <typename Type, typename Allocator, typename TailPolicy, typename StatsPolicy, typename InlinePolicy, typename FingerprintPolicy, typename IndexPolicy>
+    auto InsertAfter(SingleLinkedList<Type, Allocator, TailPolicy, StatsPolicy, InlinePolicy, FingerprintPolicy, IndexPolicy>& list, typename SingleLinkedList<Type, Allocator, TailPolicy, StatsPolicy, InlinePolicy, FingerprintPolicy, IndexPolicy>::ConstIterator pos, const Type& value)
+    {
+        return list.insert(pos, value);
+    }
+
+    template <typename Type, typename Allocator>
+    auto InsertAfter(std::forward_list<Type, Allocator>& list, typename std::forward_list<Type, Allocator>::const_iterator pos, const Type& value)
+    {
+        return list.insert_after(pos, value);
+    }
+
+    template <typename Type, typename Allocator, typename TailPolicy, typename StatsPolicy, typename InlinePolicy, typename FingerprintPolicy, typename IndexPolicy>
+    void EraseAfter(SingleLinkedList<Type, Allocator, TailPolicy, StatsPolicy, InlinePolicy, FingerprintPolicy, IndexPolicy>& list, typename SingleLinkedList<Type, Allocator, TailPolicy, StatsPolicy, InlinePolicy, FingerprintPolicy, IndexPolicy>::ConstIterator pos)
+    {
+        list.erase(pos);
+    }
+
+    template <typename Type, typename Allocator>
+    void EraseAfter(std::forward_list<Type, Allocator>& list, typename std::forward_list<Type, Allocator>::const_iterator pos)
+    {
+        list.erase_after(pos);
+    }
+
+    template <typename List>
+    List MakeList(size_t size)
+    {
+        List list;
+        for (size_t i = size; i > 0; --i)
+        {
+            list.push_front(MakeValue<typename List::value_type>(i - 1));
+        }
+        return list;
+    }
+
+    // Rough upper bound of the memory one list of this size occupies, used to skip sizes
+    // that would not fit into --max-bytes.
+    template <typename Type>
+    size_t EstimateListBytes(size_t size)
+    {
+        const size_t owned = std::is_same_v<Type, std::string> ? 48 : 0;
+        return size * (sizeof(Type) + sizeof(void*) + 16 + owned);
+    }
+
+    template <typename List>
+    void RunListOperations(BenchmarkRunner& runner, size_t size)
+    {
+        using Type = typename List::value_type;
+        const auto make_case = [size](const char* name) {
+            return BenchmarkCase{ "list", name, ContainerName<List>::value, TypeName<Type>(), size, 1 };
+        };
+
+        runner.run(make_case("push_front"), size,
+            [size]() {
+                std::vector<Type> values;
+                values.reserve(size);
+                for (size_t i = 0; i < size; ++i)
+                {
+                    values.push_back(MakeValue<Type>(i));
+                }
+                return std::make_pair(List{}, std::move(values));
+            },
+            [](auto& state) {
+                for (const Type& value : state.second)
+                {
+                    state.first.push_front(value);
+                }
+                DoNotOptimize(state.first);
+            });
+
+        // The whole range in one call.
+        runner.run(make_case("insert_range"), size,
+            [size]() {
+                std::vector<Type> values;
+                values.reserve(size);
+                for (size_t i = 0; i < size; ++i)
+                {
+                    values.push_back(MakeValue<Type>(i));
+                }
+                return std::make_pair(List{}, std::move(values));
+            },
+            [](auto& state) {
+                state.first.insert_after(state.first.cbefore_begin(), state.second.begin(), state.second.end());
+                DoNotOptimize(state.first);
+            });
+
+        const List source = MakeList<List>(size);
+
+        // The copy constructor and the initializer_list constructor share the chain-building path.
+        // Held by unique_ptr rather than std::optional, which GCC 12 in C++20 mode flags as
+        // maybe uninitialized; the one extra small allocation does not depend on size.
+        runner.run(make_case("copy_construct"), size,
+            []() { return std::unique_ptr<List>(); },
+            [&source](auto& state) {
+                state = std::make_unique<List>(source);
+                DoNotOptimize(*state);
+            });
+
+        runner.run(make_case("copy_assign"), size,
+            [size]() { return MakeList<List>(size / 2 + 1); },
+            [&source](auto& state) {
+                state = source;
+                DoNotOptimize(state);
+            });
+
+        // Into a list of the same length, so every node can be reused.
+        runner.run(make_case("assign_reuse"), size,
+            [&source]() { return List(source); },
+            [&source](auto& state) {
+                state.assign(source.begin(), source.end());
+                DoNotOptimize(state);
+            });
+
+        runner.run(make_case("clear"), size,
+            [&source]() { return List(source); },
+            [](auto& state) {
+                state.clear();
+                DoNotOptimize(state);
+            });
+
+        // Bulk removal of every other element, in one pass.
+        runner.run(make_case("remove_if"), size,
+            [&source]() { return List(source); },
+            [](auto& state) {
+                size_t index = 0;
+                state.remove_if([&index](const Type&) { return index++ % 2 == 0; });
+                DoNotOptimize(state);
+            });
+
+        runner.run(make_case("unique"), size,
+            [size]() {
+                List list;
+                for (size_t i = size; i > 0; --i)
+                {
+                    list.push_front(MakeValue<Type>((i - 1) / 2));
+                }
+                return list;
+            },
+            [](auto& state) {
+                state.unique([](const Type& lhs, const Type& rhs) { return !(lhs < rhs) && !(rhs < lhs); });
+                DoNotOptimize(state);
+            });
+
+        runner.run(make_case("reverse"), size,
+            [&source]() { return List(source); },
+            [](auto& state) {
+                state.reverse();
+                DoNotOptimize(state);
+            });
+
+        runner.run(make_case("erase_after_range"), size,
+            [&source]() { return List(source); },
+            [](auto& state) {
+                state.erase_after(state.cbegin(), state.cend());
+                DoNotOptimize(state);
+            });
+
+        runner.run(make_case("iterate"), size,
+            []() { return 0; },
+            [&source](auto&) {
+                size_t sum = 0;
+                for (const Type& value : source)
+                {
+                    sum += Touch(value);
+                }
+                DoNotOptimize(sum);
+            });
+
+        // Every operation walks to a random position, so bound the total walk length.
+        const size_t operations = std::clamp<size_t>(20'000'000 / size, 1, 256);
+        runner.run(make_case("insert_erase_random"), operations * 2,
+            [&source, operations, size]() {
+                std::mt19937_64 random(size);
+                std::vector<size_t> positions(operations);
+                for (size_t& pos : positions)
+                {
+                    pos = random() % size;
+                }
+                return std::make_pair(List(source), std::move(positions));
+            },
+            [](auto& state) {
+                List& list = state.first;
+                const Type value = MakeValue<Type>(0);
+                for (const size_t pos : state.second)
+                {
+                    auto it = list.cbefore_begin();
+                    for (size_t i = 0; i < pos; ++i)
+                    {
+                        ++it;
+                    }
+                    InsertAfter(list, it, value);
+                    EraseAfter(list, it);
+                }
+                DoNotOptimize(list);
+            });
+
+        const List equal_copy(source);
+        runner.run(make_case("compare_equal"), size,
+            []() { return 0; },
+            [&source, &equal_copy](auto&) {
+                const bool equal = source == equal_copy;
+                DoNotOptimize(equal);
+            });
+
+        runner.run(make_case("compare_less"), size,
+            []() { return 0; },
+            [&source, &equal_copy](auto&) {
+                const bool less = source < equal_copy;
+                DoNotOptimize(less);
+            });
+    }
+
+    template <typename Type>
+    void RunListSuite(BenchmarkRunner& runner)
+    {
+        for (const size_t size : runner.sizes())
+        {
+            // copy_assign and the comparisons keep three lists alive at once.
+            if (!runner.fits(EstimateListBytes<Type>(size) * 3))
+            {
+                std::cerr << "list/" << TypeName<Type>() << "/" << size << ": skipped, exceeds --max-bytes\n";
+                continue;
+            }
+            RunListOperations<SingleLinkedList<Type>>(runner, size);
+            RunListOperations<std::forward_list<Type>>(runner, size);
+        }
+    }
+
+    template <typename List>
+    void RunLayoutOperations(BenchmarkRunner& runner, size_t size)
+    {
+        using Type = typename List::value_type;
+        const auto make_case = [size](const char* name) {
+            return BenchmarkCase{ "layout", name, ContainerName<List>::value, TypeName<Type>(), size, 1 };
+        };
+        if (!runner.selected(make_case("iterate")) && !runner.selected(make_case("copy")))
+        {
+            return;
+        }
+
+        size_t bytes = 0;
+        List list((typename List::allocator_type(&bytes)));
+        for (size_t i = size; i > 0; --i)
+        {
+            list.push_front(MakeValue<Type>(i - 1));
+        }
+        const double bytes_per_element = static_cast<double>(bytes) / static_cast<double>(size);
+
+        if (runner.selected(make_case("iterate")))
+        {
+            BenchmarkResult* result = runner.run(make_case("iterate"), size,
+                []() { return 0; },
+                [&list](auto&) {
+                    size_t sum = 0;
+                    for (const Type& value : list)
+                    {
+                        sum += Touch(value);
+                    }
+                    DoNotOptimize(sum);
+                });
+            result->counters.emplace_back("container_bytes_per_element", bytes_per_element);
+        }
+
+        // Node layouts copy node by node; CompactList copies its array in one piece.
+        if (runner.selected(make_case("copy")))
+        {
+            runner.run(make_case("copy"), size,
+                []() { return std::unique_ptr<List>(); },
+                [&list](auto& state) {
+                    state = std::make_unique<List>(list);
+                    DoNotOptimize(*state);
+                });
+        }
+    }
+
+    // Node-per-element layouts against the unrolled and the index-linked layouts: traversal
+    // and copy speed and the bytes the container requests from its allocator per element
+    // (allocator headers excluded).
+    template <typename Type>
+    void RunLayoutSuite(BenchmarkRunner& runner)
+    {
+        for (const size_t size : runner.sizes())
+        {
+            if (!runner.fits(EstimateListBytes<Type>(size)))
+            {
+                continue;
+            }
+            RunLayoutOperations<SingleLinkedList<Type, ByteCountingAllocator<Type>>>(runner, size);
+            RunLayoutOperations<std::forward_list<Type, ByteCountingAllocator<Type>>>(runner, size);
+            RunLayoutOperations<UnrolledLinkedList<Type, kDefaultUnrolledChunkCapacity<Type>, ByteCountingAllocator<Type>>>(runner, size);
+            RunLayoutOperations<CompactList<Type, ByteCountingAllocator<Type>>>(runner, size);
+        }
+    }
+
+    // Traversal of a list whose nodes are scattered across the heap in random order: a plain
+    // iterator loop against the prefetching member algorithms at several distances. Only
+    // sizes from 100000 up are run, since smaller lists fit into cache.
+    void RunTraversalSuite(BenchmarkRunner& runner)
+    {
+        for (const size_t size : runner.sizes())
+        {
+            if (size < 100'000 || !runner.fits(EstimateListBytes<int>(size)))
+            {
+                continue;
+            }
+            const auto make_case = [size](std::string name) {
+                return BenchmarkCase{ "traversal", std::move(name), "SingleLinkedList", "int", size, 1 };
+            };
+
+            // Sorting random values relinks the nodes, so list order no longer follows allocation order.
+            SingleLinkedList<int> list;
+            std::mt19937 random(static_cast<unsigned>(size));
+            for (size_t i = 0; i < size; ++i)
+            {
+                list.push_front(static_cast<int>(random() >> 1));
+            }
+            list.sort();
+
+            const auto odd = [](int value) {
+                return value % 2 != 0;
+            };
+
+            runner.run(make_case("iterator_loop_sum"), size,
+                []() { return 0; },
+                [&list](auto&) {
+                    long long sum = 0;
+                    for (const int value : list)
+                    {
+                        sum += value;
+                    }
+                    DoNotOptimize(sum);
+                });
+
+            runner.run(make_case("iterator_loop_count_if"), size,
+                []() { return 0; },
+                [&list, &odd](auto&) {
+                    const auto count = std::count_if(list.cbegin(), list.cend(), odd);
+                    DoNotOptimize(count);
+                });
+
+            if (BenchmarkResult* result = runner.run(make_case("fragmentation_estimate"), size,
+                    []() { return 0; },
+                    [&list](auto&) {
+                        const double fragmentation = list.fragmentation();
+                        DoNotOptimize(fragmentation);
+                    }))
+            {
+                result->counters.emplace_back("fragmentation", list.fragmentation());
+            }
+
+            for (const size_t distance : { 0, 4, 8, 16, 32 })
+            {
+                const std::string suffix = "/prefetch:" + std::to_string(distance);
+
+                runner.run(make_case("accumulate" + suffix), size,
+                    []() { return 0; },
+                    [&list, distance](auto&) {
+                        const long long sum = list.accumulate(0LL, std::plus<>{}, distance);
+                        DoNotOptimize(sum);
+                    });
+
+                runner.run(make_case("count_if" + suffix), size,
+                    []() { return 0; },
+                    [&list, &odd, distance](auto&) {
+                        const size_t count = list.count_if(odd, distance);
+                        DoNotOptimize(count);
+                    });
+
+                runner.run(make_case("find_if_miss" + suffix), size,
+                    []() { return 0; },
+                    [&list, distance](auto&) {
+                        const auto it = list.find_if([](int value) { return value < 0; }, distance);
+                        DoNotOptimize(it);
+                    });
+            }
+
+            SingleLinkedList<int> defragmented(list);
+            runner.run(make_case("defragment"), size,
+                []() { return 0; },
+                [&defragmented](auto&) {
+                    defragmented.defragment();
+                    DoNotOptimize(defragmented);
+                });
+
+            if (BenchmarkResult* result = runner.run(make_case("iterator_loop_sum/defragmented"), size,
+                    []() { return 0; },
+                    [&defragmented](auto&) {
+                        long long sum = 0;
+                        for (const int value : defragmented)
+                        {
+                            sum += value;
+                        }
+                        DoNotOptimize(sum);
+                    }))
+            {
+                result->counters.emplace_back("fragmentation", defragmented.fragmentation());
+            }
+        }
+    }
+
+    // Parallel algorithms on 1 to max_threads cores. A run with t threads uses a pool of
+    // t - 1 workers plus the calling thread; one thread processes the list as a single
+    // segment. The nodes are laid out in list order, where the single walk that finds the
+    // segment boundaries is cheap; on scattered lists that walk bounds the speedup.
+    void RunParallelSuite(BenchmarkRunner& runner)
+    {
+        size_t max_threads = runner.options().max_threads;
+        if (max_threads == 0)
+        {
+            max_threads = std::max<size_t>(std::thread::hardware_concurrency(), 1);
+        }
+
+        for (const size_t size : runner.sizes())
+        {
+            if (size < 100'000 || !runner.fits(EstimateListBytes<int>(size)))
+            {
+                continue;
+            }
+
+            // Earlier suites leave the heap fragmented; defragment for a known layout.
+            SingleLinkedList<int> list = MakeList<SingleLinkedList<int>>(size);
+            list.defragment();
+            const auto heavy = [](int value) {
+                unsigned hash = static_cast<unsigned>(value);
+                for (int round = 0; round < 16; ++round)
+                {
+                    hash ^= hash >> 15;
+                    hash *= 2654435761u;
+                }
+                return static_cast<int>(hash >> 1);
+            };
+
+            for (size_t threads = 1; threads <= max_threads; threads *= 2)
+            {
+                WorkStealingThreadPool pool(threads - 1);
+                const ParallelPolicy policy{ &pool };
+                const auto make_case = [size, threads](const char* name) {
+                    return BenchmarkCase{ "parallel", name, "SingleLinkedList", "int", size, threads };
+                };
+
+                runner.run(make_case("reduce"), size,
+                    []() { return 0; },
+                    [&list, &policy](auto&) {
+                        const long long sum = list.reduce(policy, 0LL);
+                        DoNotOptimize(sum);
+                    });
+
+                runner.run(make_case("count_if"), size,
+                    []() { return 0; },
+                    [&list, &policy](auto&) {
+                        const size_t count = list.count_if(policy, [](int value) { return value % 2 != 0; });
+                        DoNotOptimize(count);
+                    });
+
+                runner.run(make_case("transform_inplace"), size,
+                    []() { return 0; },
+                    [&list, &policy](auto&) {
+                        list.transform_inplace(policy, [](int value) { return value ^ 1; });
+                        DoNotOptimize(list);
+                    });
+
+                runner.run(make_case("for_each_heavy"), size,
+                    []() { return 0; },
+                    [&list, &policy, &heavy](auto&) {
+                        list.for_each(policy, [&heavy](int& value) { value = heavy(value); });
+                        DoNotOptimize(list);
+                    });
+            }
+        }
+    }
+
+    // Many short lists built and destroyed: inline node storage against heap-only nodes.
+    template <typename List>
+    void RunSmallListOperations(BenchmarkRunner& runner, const char* container, size_t length)
+    {
+        constexpr size_t kLists = 10'000;
+        const BenchmarkCase bench_case{ "small_list", "build_destroy", container, "int", length, 1 };
+
+        size_t bytes = 0;
+        if (BenchmarkResult* result = runner.run(bench_case, kLists,
+                []() { return 0; },
+                [length, &bytes](auto&) {
+                    for (size_t i = 0; i < kLists; ++i)
+                    {
+                        List list((typename List::allocator_type(&bytes)));
+                        for (size_t j = 0; j < length; ++j)
+                        {
+                            list.push_front(static_cast<int>(j));
+                        }
+                        DoNotOptimize(list);
+                    }
+                }))
+        {
+            List probe((typename List::allocator_type(&bytes)));
+            const size_t before = bytes;
+            for (size_t j = 0; j < length; ++j)
+            {
+                probe.push_front(static_cast<int>(j));
+            }
+            result->counters.emplace_back("heap_bytes_per_list", static_cast<double>(bytes - before));
+        }
+    }
+
+    void RunSmallListSuite(BenchmarkRunner& runner)
+    {
+        using HeapList = SingleLinkedList<int, ByteCountingAllocator<int>>;
+        using InlineList = SingleLinkedList<int, ByteCountingAllocator<int>, NoTailTracking, NoListStats, InlineNodes<8>>;
+        for (const size_t length : { 1, 4, 8, 16 })
+        {
+            RunSmallListOperations<HeapList>(runner, "SingleLinkedList", length);
+            RunSmallListOperations<InlineList>(runner, "SingleLinkedList/inline:8", length);
+        }
+    }
+
+    // Time the calling thread spends dropping a large list: clear() against clear_async(),
+    // which hands the nodes to a NodeReclaimer. The reclaimer is drained before each
+    // iteration, outside the timed part, so its work never piles up.
+    void RunReclaimSuite(BenchmarkRunner& runner)
+    {
+        NodeReclaimer reclaimer;
+        for (const size_t size : runner.sizes())
+        {
+            if (size < 100'000 || !runner.fits(EstimateListBytes<std::string>(size)))
+            {
+                continue;
+            }
+            const auto make_case = [size](const char* name) {
+                return BenchmarkCase{ "reclaim", name, "SingleLinkedList", "std::string", size, 1 };
+            };
+            const auto setup = [size, &reclaimer]() {
+                reclaimer.drain();
+                return MakeList<SingleLinkedList<std::string>>(size);
+            };
+
+            runner.run(make_case("clear"), size, setup,
+                [](auto& list) {
+                    list.clear();
+                    DoNotOptimize(list);
+                });
+
+            runner.run(make_case("clear_async"), size, setup,
+                [&reclaimer](auto& list) {
+                    list.clear_async(reclaimer);
+                    DoNotOptimize(list);
+                });
+        }
+        reclaimer.drain();
+    }
+
+    // Random positional reads: walking from the front against the checkpoint index of
+    // PositionIndex<64>, built once before the timed part, as in a list read far more than
+    // it is relinked.
+    void RunPositionSuite(BenchmarkRunner& runner)
+    {
+        using IndexedList = SingleLinkedList<int, std::allocator<int>, NoTailTracking, NoListStats, NoInlineNodes, NoFingerprint, PositionIndex<64>>;
+        for (const size_t size : runner.sizes())
+        {
+            if (size < 1000 || !runner.fits(EstimateListBytes<int>(size) * 2))
+            {
+                continue;
+            }
+            const auto make_case = [size](const char* name, const char* container) {
+                return BenchmarkCase{ "position", name, container, "int", size, 1 };
+            };
+            // Bound the total walk length, as for insert_erase_random.
+            const size_t operations = std::clamp<size_t>(20'000'000 / size, 16, 4096);
+            std::mt19937_64 random(size);
+            std::vector<size_t> positions(operations);
+            for (size_t& pos : positions)
+            {
+                pos = random() % size;
+            }
+
+            const auto plain = MakeList<SingleLinkedList<int>>(size);
+            auto indexed = MakeList<IndexedList>(size);
+            indexed.build_index();
+            const auto read_all = [&positions](const auto& list) {
+                int sum = 0;
+                for (const size_t pos : positions)
+                {
+                    sum += list.at(pos);
+                }
+                DoNotOptimize(sum);
+            };
+
+            runner.run(make_case("at", "SingleLinkedList"), operations,
+                []() { return 0; },
+                [&plain, &read_all](auto&) {
+                    read_all(plain);
+                });
+
+            runner.run(make_case("at", "SingleLinkedList/index:64"), operations,
+                []() { return 0; },
+                [&indexed, &read_all](auto&) {
+                    read_all(indexed);
+                });
+
+            // Cutting a copy in half; the halves are freed outside the timed part.
+            runner.run(make_case("split_at", "SingleLinkedList"), 1,
+                [&plain]() { return std::make_pair(SingleLinkedList<int>(plain), SingleLinkedList<int>()); },
+                [size](auto& state) {
+                    state.second = state.first.split_at(size / 2);
+                    DoNotOptimize(state);
+                });
+
+            runner.run(make_case("split_at", "SingleLinkedList/index:64"), 1,
+                [&indexed]() {
+                    auto state = std::make_pair(IndexedList(indexed), IndexedList());
+                    state.first.build_index();
+                    return state;
+                },
+                [size](auto& state) {
+                    state.second = state.first.split_at(size / 2);
+                    DoNotOptimize(state);
+                });
+        }
+    }
+
+    // Inserting a batch of random values into a sorted list of size elements: a scan from
+    // the front per value, as done by hand on a plain list, against SortedList inserting the
+    // values one by one from its finger and as one batch merged in a single pass.
+    void RunSortedSuite(BenchmarkRunner& runner)
+    {
+        for (const size_t size : runner.sizes())
+        {
+            if (size < 1000 || !runner.fits(EstimateListBytes<int>(size) * 2))
+            {
+                continue;
+            }
+            const auto make_case = [size](const char* name, const char* container) {
+                return BenchmarkCase{ "sorted", name, container, "int", size, 1 };
+            };
+            // Bound the total scan length, as for insert_erase_random.
+            const size_t batch_size = std::clamp<size_t>(20'000'000 / size, 16, size / 4);
+            std::mt19937_64 random(size);
+            std::vector<int> batch(batch_size);
+            for (int& value : batch)
+            {
+                value = static_cast<int>(random() % (2 * size));
+            }
+            SingleLinkedList<int> evens;
+            for (size_t i = size; i > 0; --i)
+            {
+                evens.push_front(static_cast<int>(2 * (i - 1)));
+            }
+
+            runner.run(make_case("insert_each", "SingleLinkedList/scan"), batch_size,
+                [&evens]() { return SingleLinkedList<int>(evens); },
+                [&batch](auto& list) {
+                    for (const int value : batch)
+                    {
+                        auto before = list.cbefore_begin();
+                        for (auto next = list.cbegin(); next != list.cend() && *next <= value; ++next)
+                        {
+                            before = next;
+                        }
+                        list.insert(before, value);
+                    }
+                    DoNotOptimize(list);
+                });
+
+            runner.run(make_case("insert_each", "SortedList"), batch_size,
+                [&evens]() { return SortedList<int>(SingleLinkedList<int>(evens)); },
+                [&batch](auto& list) {
+                    for (const int value : batch)
+                    {
+                        list.insert_sorted(value);
+                    }
+                    DoNotOptimize(list);
+                });
+
+            runner.run(make_case("insert_batch", "SortedList"), batch_size,
+                [&evens]() { return SortedList<int>(SingleLinkedList<int>(evens)); },
+                [&batch](auto& list) {
+                    list.insert_sorted(batch.begin(), batch.end());
+                    DoNotOptimize(list);
+                });
+        }
+    }
+
+    // Checkpointing to an in-memory stream: the chunked binary format against writing and
+    // reading the elements one by one, as text and as raw binary.
+    template <typename Type>
+    void RunSerializationSuite(BenchmarkRunner& runner)
+    {
+        for (const size_t size : runner.sizes())
+        {
+            // The list, its copy being read and the serialized bytes.
+            if (size < 1000 || !runner.fits(EstimateListBytes<Type>(size) * 3))
+            {
+                continue;
+            }
+            const auto make_case = [size](const char* name) {
+                return BenchmarkCase{ "serialization", name, "SingleLinkedList", TypeName<Type>(), size, 1 };
+            };
+
+            const auto source = MakeList<SingleLinkedList<Type>>(size);
+            std::stringstream serialized;
+            source.serialize(serialized);
+            const std::string bytes = serialized.str();
+
+            runner.run(make_case("serialize"), size,
+                []() { return std::ostringstream{}; },
+                [&source](auto& out) {
+                    source.serialize(out);
+                    DoNotOptimize(out);
+                });
+
+            runner.run(make_case("deserialize"), size,
+                [&bytes]() { return std::make_pair(std::istringstream(bytes), SingleLinkedList<Type>{}); },
+                [](auto& state) {
+                    state.second.deserialize(state.first);
+                    DoNotOptimize(state.second);
+                });
+
+            if constexpr (std::is_same_v<Type, int>)
+            {
+                runner.run(make_case("element_write_text"), size,
+                    []() { return std::ostringstream{}; },
+                    [&source](auto& out) {
+                        for (const int value : source)
+                        {
+                            out << value << ' ';
+                        }
+                        DoNotOptimize(out);
+                    });
+
+                std::ostringstream text;
+                for (const int value : source)
+                {
+                    text << value << ' ';
+                }
+                runner.run(make_case("element_read_text"), size,
+                    [text = text.str()]() { return std::make_pair(std::istringstream(text), SingleLinkedList<Type>{}); },
+                    [](auto& state) {
+                        auto last = state.second.before_begin();
+                        int value = 0;
+                        while (state.first >> value)
+                        {
+                            last = state.second.insert(last, value);
+                        }
+                        DoNotOptimize(state.second);
+                    });
+
+                runner.run(make_case("element_write_binary"), size,
+                    []() { return std::ostringstream{}; },
+                    [&source](auto& out) {
+                        for (const int value : source)
+                        {
+                            out.write(reinterpret_cast<const char*>(&value), sizeof(value));
+                        }
+                        DoNotOptimize(out);
+                    });
+            }
+        }
+    }
+
+    class MutexStack
+    {
+    public:
+        void push_front(int value)
+        {
+            std::lock_guard lock(mutex_);
+            list_.push_front(value);
+        }
+
+        std::optional<int> try_pop_front()
+        {
+            std::lock_guard lock(mutex_);
+            if (list_.empty())
+            {
+                return std::nullopt;
+            }
+            const int value = *list_.begin();
+            list_.pop_front();
+            return value;
+        }
+
+    private:
+        std::mutex mutex_;
+        SingleLinkedList<int> list_;
+    };
+
+    template <typename Stack>
+    void RunStackThroughput(BenchmarkRunner& runner, const char* container, size_t threads)
+    {
+        constexpr size_t kPairsPerThread = 200'000;
+        const BenchmarkCase bench_case{ "stack", "push_pop_pairs", container, "int", kPairsPerThread, threads };
+
+        runner.run(bench_case, kPairsPerThread * threads * 2,
+            [threads]() {
+                if constexpr (std::is_same_v<Stack, MutexStack>)
+                {
+                    return std::make_unique<Stack>();
+                }
+                else
+                {
+                    return std::make_unique<Stack>(threads);
+                }
+            },
+            [threads](auto& stack) {
+                std::vector<std::thread> workers;
+                for (size_t t = 0; t < threads; ++t)
+                {
+                    workers.emplace_back([&stack]() {
+                        size_t sum = 0;
+                        for (size_t i = 0; i < kPairsPerThread; ++i)
+                        {
+                            stack->push_front(static_cast<int>(i));
+                            if (const auto value = stack->try_pop_front())
+                            {
+                                sum += static_cast<size_t>(*value);
+                            }
+                        }
+                        DoNotOptimize(sum);
+                    });
+                }
+                for (auto& worker : workers)
+                {
+                    worker.join();
+                }
+            });
+    }
+
+    // Event ingestion baseline: producers append to a tail-tracking list under a mutex and
+    // the consumer swaps the whole list out under the same mutex.
+    class MutexQueue
+    {
+    public:
+        void push(int value)
+        {
+            std::lock_guard lock(mutex_);
+            list_.push_back(value);
+        }
+
+        template <typename Function>
+        size_t drain(Function func)
+        {
+            SingleLinkedList<int, std::allocator<int>, TailTracking> taken;
+            {
+                std::lock_guard lock(mutex_);
+                taken.swap(list_);
+            }
+            for (const int value : taken)
+            {
+                func(value);
+            }
+            return taken.size();
+        }
+
+    private:
+        std::mutex mutex_;
+        SingleLinkedList<int, std::allocator<int>, TailTracking> list_;
+    };
+
+    // threads producers push kPerProducer elements each while one consumer drains them.
+    template <typename Queue>
+    void RunQueueThroughput(BenchmarkRunner& runner, const char* container, size_t threads)
+    {
+        constexpr size_t kPerProducer = 200'000;
+        const BenchmarkCase bench_case{ "queue", "produce_drain", container, "int", kPerProducer, threads };
+
+        runner.run(bench_case, kPerProducer * threads,
+            []() { return std::make_unique<Queue>(); },
+            [threads](auto& queue) {
+                std::vector<std::thread> producers;
+                for (size_t t = 0; t < threads; ++t)
+                {
+                    producers.emplace_back([&queue]() {
+                        if constexpr (std::is_same_v<Queue, MutexQueue>)
+                        {
+                            for (size_t i = 0; i < kPerProducer; ++i)
+                            {
+                                queue->push(static_cast<int>(i));
+                            }
+                        }
+                        else
+                        {
+                            auto producer = queue->producer();
+                            for (size_t i = 0; i < kPerProducer; ++i)
+                            {
+                                producer.push(static_cast<int>(i));
+                            }
+                        }
+                    });
+                }
+                size_t received = 0;
+                size_t sum = 0;
+                while (received < kPerProducer * threads)
+                {
+                    const size_t drained = queue->drain([&sum](int value) {
+                        sum += static_cast<size_t>(value);
+                    });
+                    if (drained == 0)
+                    {
+                        std::this_thread::yield();
+                    }
+                    received += drained;
+                }
+                for (auto& producer : producers)
+                {
+                    producer.join();
+                }
+                DoNotOptimize(sum);
+            });
+    }
+
+    // Many producers, one consumer: the mutex-guarded list against MpscQueue, by producer count.
+    void RunQueueSuite(BenchmarkRunner& runner)
+    {
+        size_t max_threads = runner.options().max_threads;
+        if (max_threads == 0)
+        {
+            max_threads = std::max<size_t>(std::thread::hardware_concurrency(), 1);
+        }
+        for (size_t threads = 1; threads <= max_threads; threads *= 2)
+        {
+            RunQueueThroughput<MutexQueue>(runner, "mutex+SingleLinkedList", threads);
+            RunQueueThroughput<MpscQueue<int>>(runner, "MpscQueue", threads);
+        }
+    }
+
+    // Shared LIFO work stack: mutex-guarded SingleLinkedList against the lock-free ConcurrentStack.
+    void RunStackSuite(BenchmarkRunner& runner)
+    {
+        size_t max_threads = runner.options().max_threads;
+        if (max_threads == 0)
+        {
+            max_threads = std::max<size_t>(std::thread::hardware_concurrency(), 1);
+        }
+        for (size_t threads = 1; threads <= max_threads; threads *= 2)
+        {
+            RunStackThroughput<MutexStack>(runner, "mutex+SingleLinkedList", threads);
+            RunStackThroughput<ConcurrentStack<int>>(runner, "ConcurrentStack", threads);
+        }
+    }
+
+#if CUSTOM_LIST_RANGES
+    // A filter, map and take chain over a list of size ints: each step materialized into a
+    // list of its own, against one fused pass of views collected by ToList(). Reports the
+    // allocations per run next to the time.
+    void RunPipelineSuite(BenchmarkRunner& runner)
+    {
+        using List = SingleLinkedList<int, AllocationCountingAllocator<int>>;
+        const auto is_even = [](int value) {
+            return value % 2 == 0;
+        };
+        const auto triple = [](int value) {
+            return 3 * value;
+        };
+
+        for (const size_t size : runner.sizes())
+        {
+            if (!runner.fits(EstimateListBytes<int>(size) * 3))
+            {
+                continue;
+            }
+            const auto make_case = [size](const char* name) {
+                return BenchmarkCase{ "pipeline", name, "SingleLinkedList", "int", size, 1 };
+            };
+            const size_t take_count = size / 4;
+            const SingleLinkedList<int> source = MakeList<SingleLinkedList<int>>(size);
+            size_t allocations = 0;
+            const auto report = [&allocations](BenchmarkResult* result) {
+                if (result != nullptr)
+                {
+                    result->counters.emplace_back("allocations_per_run", static_cast<double>(allocations) / static_cast<double>(result->iterations));
+                }
+            };
+
+            report(runner.run(make_case("materialize"), size,
+                []() { return 0; },
+                [&source, &allocations, is_even, triple, take_count](auto&) {
+                    const AllocationCountingAllocator<int> alloc(&allocations);
+                    List evens(alloc);
+                    auto last = evens.before_begin();
+                    for (const int value : source)
+                    {
+                        if (is_even(value))
+                        {
+                            last = evens.insert(last, value);
+                        }
+                    }
+                    List tripled(alloc);
+                    last = tripled.before_begin();
+                    for (const int value : evens)
+                    {
+                        last = tripled.insert(last, triple(value));
+                    }
+                    List taken(alloc);
+                    last = taken.before_begin();
+                    for (auto it = tripled.begin(); it != tripled.end() && taken.size() < take_count; ++it)
+                    {
+                        last = taken.insert(last, *it);
+                    }
+                    DoNotOptimize(taken);
+                }));
+
+            allocations = 0;
+            report(runner.run(make_case("fused"), size,
+                []() { return 0; },
+                [&source, &allocations, is_even, triple, take_count](auto&) {
+                    List taken = source | std::views::filter(is_even) | std::views::transform(triple) | std::views::take(take_count)
+                        | ToList<List>(AllocationCountingAllocator<int>(&allocations));
+                    DoNotOptimize(taken);
+                }));
+        }
+    }
+#endif
+}
+
+int main(int argc, char* argv[])
+{
+    BenchmarkRunner runner(ParseBenchmarkOptions(argc, argv));
+
+    RunListSuite<int>(runner);
+    RunListSuite<std::string>(runner);
+    RunListSuite<Payload256>(runner);
+
+    RunLayoutSuite<int>(runner);
+    RunLayoutSuite<Payload256>(runner);
+
+    RunTraversalSuite(runner);
+
+    RunParallelSuite(runner);
+
+    RunSmallListSuite(runner);
+
+    RunReclaimSuite(runner);
+
+    RunPositionSuite(runner);
+
+    RunSortedSuite(runner);
+
+    RunSerializationSuite<int>(runner);
+    RunSerializationSuite<std::string>(runner);
+
+    RunStackSuite(runner);
+
+    RunQueueSuite(runner);
+
+#if CUSTOM_LIST_RANGES
+    RunPipelineSuite(runner);
+#endif
+
+    if (runner.options().json_path.empty())
+    {
+        runner.write_json(std::cout);
+    }
+    else
+    {
+        std::ofstream out(runner.options().json_path);
+        runner.write_json(out);
+        if (!out)
+        {
+            std::cerr << "failed to write " << runner.options().json_path << "\n";
+            return 1;
+        }
+    }
+}
@@ -0,0 +1,250 @@
+#pragma once
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <ostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+template <typename T>
+inline void DoNotOptimize(const T& value)
+{
+#if defined(__GNUC__) || defined(__clang__)
+    asm volatile("" : : "g"(&value) : "memory");
+#else
+    static volatile const void* sink = nullptr;
+    sink = &value;
+#endif
+}
+
+struct BenchmarkOptions
+{
+    size_t min_size = 10;
+    size_t max_size = 10'000'000;
+    size_t max_bytes = size_t{ 4 } << 30;
+    size_t max_threads = 0;
+    double min_time_seconds = 0.1;
+    std::string filter;
+    std::string json_path;
+};
+
+struct BenchmarkCase
+{
+    std::string suite;
+    std::string name;
+    std::string container;
+    std::string type;
+    size_t size = 0;
+    size_t threads = 1;
+};
+
+struct BenchmarkResult
+{
+    BenchmarkCase bench_case;
+    size_t iterations = 0;
+    size_t ops_per_iteration = 0;
+    double ns_per_op = 0.0;
+    std::vector<std::pair<std::string, double>> counters;
+};
+
+// Times benchmark bodies and collects the results as JSON. Every iteration gets a fresh
+// state from setup(); only body(state) is timed, so building and destroying fixtures is
+// excluded. Iterations repeat until min_time_seconds of timed work has accumulated.
+class BenchmarkRunner
+{
+public:
+    explicit BenchmarkRunner(BenchmarkOptions options) : options_(std::move(options)) {}
+
+    [[nodiscard]] const BenchmarkOptions& options() const noexcept
+    {
+        return options_;
+    }
+
+    // Decimal sizes from 10 up, restricted to [min_size, max_size].
+    [[nodiscard]] std::vector<size_t> sizes() const
+    {
+        std::vector<size_t> result;
+        for (size_t size = 10; size <= options_.max_size; size *= 10)
+        {
+            if (size >= options_.min_size)
+            {
+                result.push_back(size);
+            }
+        }
+        return result;
+    }
+
+    [[nodiscard]] bool selected(const BenchmarkCase& bench_case) const
+    {
+        return options_.filter.empty() || full_name(bench_case).find(options_.filter) != std::string::npos;
+    }
+
+    [[nodiscard]] bool fits(size_t bytes) const noexcept
+    {
+        return bytes <= options_.max_bytes;
+    }
+
+    template <typename Setup, typename Body>
+    BenchmarkResult* run(const BenchmarkCase& bench_case, size_t ops_per_iteration, Setup setup, Body body)
+    {
+        if (!selected(bench_case))
+        {
+            return nullptr;
+        }
+
+        using Clock = std::chrono::steady_clock;
+        const auto min_time = std::chrono::duration<double>(options_.min_time_seconds);
+
+        Clock::duration elapsed{};
+        size_t iterations = 0;
+        do
+        {
+            auto state = setup();
+            const auto start = Clock::now();
+            body(state);
+            elapsed += Clock::now() - start;
+            ++iterations;
+        } while (elapsed < min_time);
+
+        BenchmarkResult result;
+        result.bench_case = bench_case;
+        result.iterations = iterations;
+        result.ops_per_iteration = std::max<size_t>(ops_per_iteration, 1);
+        result.ns_per_op = std::chrono::duration<double, std::nano>(elapsed).count() / static_cast<double>(iterations * result.ops_per_iteration);
+        results_.push_back(std::move(result));
+
+        const BenchmarkResult& stored = results_.back();
+        std::cerr << full_name(stored.bench_case) << ": " << stored.ns_per_op << " ns/op (" << stored.iterations << " iterations)\n";
+        return &results_.back();
+    }
+
+    void write_json(std::ostream& out) const
+    {
+        out << "{\n  \"context\": {\n";
+        out << "    \"compiler\": \"" << escape(compiler_name()) << "\",\n";
+#if defined(NDEBUG)
+        out << "    \"assertions\": false,\n";
+#else
+        out << "    \"assertions\": true,\n";
+#endif
+        out << "    \"min_time_seconds\": " << options_.min_time_seconds << "\n";
+        out << "  },\n  \"benchmarks\": [";
+        for (size_t i = 0; i < results_.size(); ++i)
+        {
+            const BenchmarkResult& result = results_[i];
+            const BenchmarkCase& bench_case = result.bench_case;
+            out << (i == 0 ? "\n" : ",\n");
+            out << "    {\"suite\": \"" << escape(bench_case.suite) << "\", \"name\": \"" << escape(bench_case.name)
+                << "\", \"container\": \"" << escape(bench_case.container) << "\", \"type\": \"" << escape(bench_case.type)
+                << "\", \"size\": " << bench_case.size << ", \"threads\": " << bench_case.threads
+                << ", \"iterations\": " << result.iterations << ", \"ops_per_iteration\": " << result.ops_per_iteration
+                << ", \"ns_per_op\": " << result.ns_per_op;
+            for (const auto& [counter, value] : result.counters)
+            {
+                out << ", \"" << escape(counter) << "\": " << value;
+            }
+            out << "}";
+        }
+        out << "\n  ]\n}\n";
+    }
+
+private:
+    BenchmarkOptions options_;
+    std::vector<BenchmarkResult> results_;
+
+    [[nodiscard]] static std::string full_name(const BenchmarkCase& bench_case)
+    {
+        std::string name = bench_case.suite + "/" + bench_case.name + "/" + bench_case.container + "/" + bench_case.type + "/" + std::to_string(bench_case.size);
+        if (bench_case.threads > 1)
+        {
+            name += "/threads:" + std::to_string(bench_case.threads);
+        }
+        return name;
+    }
+
+    [[nodiscard]] static std::string compiler_name()
+    {
+#if defined(__clang__)
+        return "clang " __clang_version__;
+#elif defined(__GNUC__)
+        return "gcc " __VERSION__;
+#elif defined(_MSC_VER)
+        return "msvc " + std::to_string(_MSC_VER);
+#else
+        return "unknown";
+#endif
+    }
+
+    [[nodiscard]] static std::string escape(const std::string& text)
+    {
+        std::string escaped;
+        for (const char c : text)
+        {
+            if (c == '"' || c == '\\')
+            {
+                escaped += '\\';
+            }
+            escaped += c;
+        }
+        return escaped;
+    }
+};
+
+// Parses --min-size, --max-size, --max-bytes, --max-threads, --min-time, --filter and --json.
+// Prints usage and exits on malformed arguments.
+inline BenchmarkOptions ParseBenchmarkOptions(int argc, char* argv[])
+{
+    BenchmarkOptions options;
+    const auto usage = [argv]() {
+        std::cerr << "usage: " << argv[0]
+                  << " [--min-size N] [--max-size N] [--max-bytes N] [--max-threads N] [--min-time SECONDS] [--filter TEXT] [--json FILE]\n";
+        std::exit(2);
+    };
+
+    for (int i = 1; i < argc; ++i)
+    {
+        const std::string arg = argv[i];
+        if (i + 1 >= argc)
+        {
+            usage();
+        }
+        const char* value = argv[++i];
+        if (arg == "--min-size")
+        {
+            options.min_size = std::strtoull(value, nullptr, 10);
+        }
+        else if (arg == "--max-size")
+        {
+            options.max_size = std::strtoull(value, nullptr, 10);
+        }
+        else if (arg == "--max-bytes")
+        {
+            options.max_bytes = std::strtoull(value, nullptr, 10);
+        }
+        else if (arg == "--max-threads")
+        {
+            options.max_threads = std::strtoull(value, nullptr, 10);
+        }
+        else if (arg == "--min-time")
+        {
+            options.min_time_seconds = std::strtod(value, nullptr);
+        }
+        else if (arg == "--filter")
+        {
+            options.filter = value;
+        }
+        else if (arg == "--json")
+        {
+            options.json_path = value;
+        }
+        else
+        {
+            usage();
+        }
+    }
+    return options;
+}
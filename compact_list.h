@@ -0,0 +1,479 @@
+#pragma once
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <iterator>
+#include <memory>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// Singly linked list whose nodes live in one growable array and link to each other by
+// 32-bit slot index instead of by pointer. An element costs its value plus four bytes,
+// padded to the alignment of Type, with no per-node allocation; erased slots go on a free
+// list threaded through the same links and are reused by later insertions. The list is a
+// vector and three integers, so it can be relocated bytewise, and copying it copies the
+// array as it stands, a single memcpy when Type is trivially copyable.
+//
+// Iterators hold the list and a slot index rather than a node address, so, as with
+// SingleLinkedList, insertions invalidate none of them even when the array grows; erase
+// invalidates only iterators to the erased element. compact() and the assignments
+// invalidate all. A freed slot keeps a live Type, reset to Type() when Type has a
+// nontrivial destructor and a default constructor, so that resources it owned are
+// released right away. At most kMaxSize elements fit.
+template <typename Type, typename Allocator = std::allocator<Type>>
+class CompactList
+{
+    // Link value of the last element, and index of end().
+    static constexpr uint32_t kNull = UINT32_MAX;
+    // Index of before_begin(), whose link is head_.
+    static constexpr uint32_t kBeforeBegin = UINT32_MAX - 1;
+
+    struct Slot
+    {
+        template <typename... Args>
+        explicit Slot(uint32_t next_slot, Args&&... args) : value(std::forward<Args>(args)...), next(next_slot) {}
+
+        Type value;
+        uint32_t next;
+    };
+
+    using SlotAllocator = typename std::allocator_traits<Allocator>::template rebind_alloc<Slot>;
+    using Slots = std::vector<Slot, SlotAllocator>;
+
+    static constexpr bool kResetErased = !std::is_trivially_destructible_v<Type> && std::is_default_constructible_v<Type>;
+    static constexpr bool kNothrowErase = !kResetErased || (std::is_nothrow_default_constructible_v<Type> && std::is_nothrow_move_assignable_v<Type>);
+
+    template <typename ValueType>
+    class BasicIterator
+    {
+
+        friend class CompactList;
+
+        using ListPointer = std::conditional_t<std::is_const_v<ValueType>, const CompactList*, CompactList*>;
+
+        explicit BasicIterator(ListPointer list, uint32_t index) : list_(list), index_(index) {}
+
+    public:
+
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = Type;
+        using difference_type = std::ptrdiff_t;
+        using pointer = ValueType*;
+        using reference = ValueType&;
+
+        BasicIterator() = default;
+
+        BasicIterator(const BasicIterator<Type>& other) noexcept : list_(other.list_), index_(other.index_) {}
+
+        BasicIterator& operator=(const BasicIterator& rhs) = default;
+
+        [[nodiscard]] bool operator==(const BasicIterator<const Type>& rhs) const noexcept
+        {
+            return this->index_ == rhs.index_;
+        }
+
+        [[nodiscard]] bool operator!=(const BasicIterator<const Type>& rhs) const noexcept
+        {
+            return !(this->index_ == rhs.index_);
+        }
+
+        [[nodiscard]] bool operator==(const BasicIterator<Type>& rhs) const noexcept
+        {
+            return this->index_ == rhs.index_;
+        }
+
+        [[nodiscard]] bool operator!=(const BasicIterator<Type>& rhs) const noexcept
+        {
+            return !(this->index_ == rhs.index_);
+        }
+
+        BasicIterator& operator++() noexcept
+        {
+            assert(index_ != kNull);
+
+            index_ = list_->next_of(index_);
+            return *this;
+        }
+
+        BasicIterator operator++(int) noexcept
+        {
+            assert(index_ != kNull);
+
+            auto old_value(*this);
+            ++(*this);
+            return old_value;
+        }
+
+        [[nodiscard]] reference operator*() const noexcept
+        {
+            assert(index_ != kNull && index_ != kBeforeBegin);
+
+            return list_->slots_[index_].value;
+        }
+
+        [[nodiscard]] pointer operator->() const noexcept
+        {
+            assert(index_ != kNull && index_ != kBeforeBegin);
+
+            return &list_->slots_[index_].value;
+        }
+
+    private:
+        ListPointer list_ = nullptr;
+        uint32_t index_ = kNull;
+    };
+
+public:
+    static constexpr size_t kMaxSize = kBeforeBegin;
+
+    CompactList() {}
+
+    explicit CompactList(const Allocator& alloc) : slots_(SlotAllocator(alloc)) {}
+
+    CompactList(std::initializer_list<Type> values, const Allocator& alloc = Allocator()) : slots_(SlotAllocator(alloc))
+    {
+        assign(values.begin(), values.end());
+    }
+
+    // Copies the array slot for slot, free slots included, so indices carry over unchanged.
+    CompactList(const CompactList& other)
+        : slots_(other.slots_), head_(other.head_), free_(other.free_), size_(other.size_)
+    {
+    }
+
+    CompactList(CompactList&& other) noexcept
+        : slots_(std::move(other.slots_))
+        , head_(std::exchange(other.head_, kNull))
+        , free_(std::exchange(other.free_, kNull))
+        , size_(std::exchange(other.size_, 0))
+    {
+        other.slots_.clear();
+    }
+
+    // Reuses the capacity of this list. If copying throws, the list is left empty.
+    CompactList& operator=(const CompactList& rhs)
+    {
+        if (this != &rhs)
+        {
+            try
+            {
+                slots_ = rhs.slots_;
+            }
+            catch (...)
+            {
+                clear();
+                throw;
+            }
+            head_ = rhs.head_;
+            free_ = rhs.free_;
+            size_ = rhs.size_;
+        }
+        return *this;
+    }
+
+    // With unequal allocators that do not propagate, the vector moves the slots one by one
+    // in array order, which keeps the indices valid.
+    CompactList& operator=(CompactList&& rhs) noexcept(std::is_nothrow_move_assignable_v<Slots>)
+    {
+        if (this != &rhs)
+        {
+            slots_ = std::move(rhs.slots_);
+            rhs.slots_.clear();
+            head_ = std::exchange(rhs.head_, kNull);
+            free_ = std::exchange(rhs.free_, kNull);
+            size_ = std::exchange(rhs.size_, 0);
+        }
+        return *this;
+    }
+
+    using value_type = Type;
+    using allocator_type = Allocator;
+    using reference = value_type&;
+    using const_reference = const value_type&;
+    using Iterator = BasicIterator<Type>;
+    using ConstIterator = BasicIterator<const Type>;
+
+    [[nodiscard]] allocator_type get_allocator() const noexcept
+    {
+        return allocator_type(slots_.get_allocator());
+    }
+
+    [[nodiscard]] Iterator begin() noexcept
+    {
+        return Iterator{ this, head_ };
+    }
+
+    [[nodiscard]] Iterator end() noexcept
+    {
+        return Iterator{ this, kNull };
+    }
+
+    [[nodiscard]] ConstIterator begin() const noexcept
+    {
+        return cbegin();
+    }
+
+    [[nodiscard]] ConstIterator end() const noexcept
+    {
+        return cend();
+    }
+
+    [[nodiscard]] ConstIterator cbegin() const noexcept
+    {
+        return ConstIterator{ this, head_ };
+    }
+
+    [[nodiscard]] ConstIterator cend() const noexcept
+    {
+        return ConstIterator{ this, kNull };
+    }
+
+    [[nodiscard]] Iterator before_begin() noexcept
+    {
+        return Iterator{ this, kBeforeBegin };
+    }
+
+    [[nodiscard]] ConstIterator cbefore_begin() const noexcept
+    {
+        return ConstIterator{ this, kBeforeBegin };
+    }
+
+    [[nodiscard]] ConstIterator before_begin() const noexcept
+    {
+        return cbefore_begin();
+    }
+
+    [[nodiscard]] size_t size() const noexcept
+    {
+        return size_;
+    }
+
+    [[nodiscard]] bool empty() const noexcept
+    {
+        return size_ == 0;
+    }
+
+    // Slots allocated, live and free; insertions beyond it grow the array.
+    [[nodiscard]] size_t capacity() const noexcept
+    {
+        return slots_.capacity();
+    }
+
+    void reserve(size_t count)
+    {
+        if (count > kMaxSize)
+        {
+            throw std::length_error("CompactList: too many elements");
+        }
+        slots_.reserve(count);
+    }
+
+    // Bytes held by the list: the object itself and the whole array, free slots included.
+    [[nodiscard]] size_t memory_footprint() const noexcept
+    {
+        return sizeof(*this) + slots_.capacity() * sizeof(Slot);
+    }
+
+    void swap(CompactList& other) noexcept
+    {
+        slots_.swap(other.slots_);
+        std::swap(other.head_, head_);
+        std::swap(other.free_, free_);
+        std::swap(other.size_, size_);
+    }
+
+    void push_front(const Type& value)
+    {
+        emplace_after(cbefore_begin(), value);
+    }
+
+    void push_front(Type&& value)
+    {
+        emplace_after(cbefore_begin(), std::move(value));
+    }
+
+    template <typename... Args>
+    reference emplace_front(Args&&... args)
+    {
+        return *emplace_after(cbefore_begin(), std::forward<Args>(args)...);
+    }
+
+    void pop_front() noexcept(kNothrowErase)
+    {
+        assert(!empty());
+
+        erase(cbefore_begin());
+    }
+
+    // Inserts value after pos and returns an iterator to it.
+    Iterator insert(ConstIterator pos, const Type& value)
+    {
+        return emplace_after(pos, value);
+    }
+
+    Iterator insert(ConstIterator pos, Type&& value)
+    {
+        return emplace_after(pos, std::move(value));
+    }
+
+    // Takes a free slot if there is one and appends to the array otherwise. If constructing
+    // the value or growing the array throws, the list is unchanged.
+    template <typename... Args>
+    Iterator emplace_after(ConstIterator pos, Args&&... args)
+    {
+        assert(pos.list_ == this && pos.index_ != kNull);
+
+        const uint32_t index = acquire_slot(std::forward<Args>(args)...);
+        uint32_t& link = link_of(pos.index_);
+        slots_[index].next = link;
+        link = index;
+        ++size_;
+        return Iterator{ this, index };
+    }
+
+    // Erases the element after pos and returns an iterator to the element that follows it.
+    Iterator erase(ConstIterator pos) noexcept(kNothrowErase)
+    {
+        assert(pos.list_ == this && pos.index_ != kNull && next_of(pos.index_) != kNull);
+
+        uint32_t& link = link_of(pos.index_);
+        const uint32_t index = link;
+        link = slots_[index].next;
+        release_slot(index);
+        --size_;
+        return Iterator{ this, link };
+    }
+
+    // Destroys every element but keeps the capacity.
+    void clear() noexcept
+    {
+        slots_.clear();
+        head_ = kNull;
+        free_ = kNull;
+        size_ = 0;
+    }
+
+    // Moves the elements into a new array of exactly size() slots, laid out in list order,
+    // so that traversal runs through memory sequentially and no free slots remain. If moving
+    // an element throws, the list is unchanged.
+    void compact()
+    {
+        Slots slots(slots_.get_allocator());
+        slots.reserve(size_);
+        for (uint32_t index = head_; index != kNull; index = slots_[index].next)
+        {
+            slots.emplace_back(static_cast<uint32_t>(slots.size() + 1), std::move_if_noexcept(slots_[index].value));
+        }
+        if (!slots.empty())
+        {
+            slots.back().next = kNull;
+        }
+        slots_.swap(slots);
+        head_ = size_ > 0 ? 0 : kNull;
+        free_ = kNull;
+    }
+
+private:
+    Slots slots_;
+    uint32_t head_ = kNull;
+    // First free slot; free slots are linked through next like the elements.
+    uint32_t free_ = kNull;
+    size_t size_ = 0;
+
+    [[nodiscard]] uint32_t next_of(uint32_t index) const noexcept
+    {
+        return index == kBeforeBegin ? head_ : slots_[index].next;
+    }
+
+    [[nodiscard]] uint32_t& link_of(uint32_t index) noexcept
+    {
+        return index == kBeforeBegin ? head_ : slots_[index].next;
+    }
+
+    template <typename... Args>
+    uint32_t acquire_slot(Args&&... args)
+    {
+        if (free_ != kNull)
+        {
+            const uint32_t index = free_;
+            slots_[index].value = Type(std::forward<Args>(args)...);
+            free_ = slots_[index].next;
+            return index;
+        }
+        if (slots_.size() == kMaxSize)
+        {
+            throw std::length_error("CompactList: too many elements");
+        }
+        slots_.emplace_back(kNull, std::forward<Args>(args)...);
+        return static_cast<uint32_t>(slots_.size() - 1);
+    }
+
+    void release_slot(uint32_t index) noexcept(kNothrowErase)
+    {
+        if constexpr (kResetErased)
+        {
+            slots_[index].value = Type();
+        }
+        slots_[index].next = free_;
+        free_ = index;
+    }
+
+    // Lays the elements out in order in a fresh array.
+    template <typename InputIterator>
+    void assign(InputIterator from, InputIterator to)
+    {
+        CompactList tmp(get_allocator());
+        ConstIterator last = tmp.cbefore_begin();
+        for (; from != to; ++from)
+        {
+            last = tmp.emplace_after(last, *from);
+        }
+        swap(tmp);
+    }
+};
+
+template <typename Type, typename Allocator>
+void swap(CompactList<Type, Allocator>& lhs, CompactList<Type, Allocator>& rhs) noexcept
+{
+    lhs.swap(rhs);
+}
+
+template <typename Type, typename Allocator>
+bool operator==(const CompactList<Type, Allocator>& lhs, const CompactList<Type, Allocator>& rhs)
+{
+    return lhs.size() == rhs.size() && std::equal(lhs.begin(), lhs.end(), rhs.begin());
+}
+
+template <typename Type, typename Allocator>
+bool operator!=(const CompactList<Type, Allocator>& lhs, const CompactList<Type, Allocator>& rhs)
+{
+    return !(lhs == rhs);
+}
+
+template <typename Type, typename Allocator>
+bool operator<(const CompactList<Type, Allocator>& lhs, const CompactList<Type, Allocator>& rhs)
+{
+    return std::lexicographical_compare(lhs.begin(), lhs.end(), rhs.begin(), rhs.end());
+}
+
+template <typename Type, typename Allocator>
+bool operator<=(const CompactList<Type, Allocator>& lhs, const CompactList<Type, Allocator>& rhs)
+{
+    return !(rhs < lhs);
+}
+
+template <typename Type, typename Allocator>
+bool operator>(const CompactList<Type, Allocator>& lhs, const CompactList<Type, Allocator>& rhs)
+{
+    return rhs < lhs;
+}
+
+template <typename Type, typename Allocator>
+bool operator>=(const CompactList<Type, Allocator>& lhs, const CompactList<Type, Allocator>& rhs)
+{
+    return !(lhs < rhs);
+}
@@ -0,0 +1,351 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <cstddef>
+#include <memory>
+#include <optional>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "custom_list.h"
+
+// Lock-free LIFO stack (Treiber stack) for use by many threads at once.
+// The head is an atomic pointer updated with compare-and-swap; popped nodes are
+// reclaimed through hazard pointers, which rules out both use-after-free and ABA:
+// a node cannot be freed, and so its address cannot be reused, while another
+// thread still holds it as a hazard.
+//
+// Every operation leases one of max_threads hazard records for its duration, so
+// at most that many threads make progress at once; further threads spin until a
+// record is free. The allocator is called concurrently and must be thread-safe.
+template <typename Type, typename Allocator = std::allocator<Type>>
+class ConcurrentStack
+{
+    struct Node
+    {
+        template <typename... Args>
+        explicit Node(Node* next, Args&&... args) : value(std::forward<Args>(args)...), next_node(next) {}
+
+        Type value;
+        std::atomic<Node*> next_node;
+    };
+
+    using NodeAllocator = typename std::allocator_traits<Allocator>::template rebind_alloc<Node>;
+    using NodeAllocTraits = std::allocator_traits<NodeAllocator>;
+
+    struct alignas(64) HazardRecord
+    {
+        std::atomic<bool> active{ false };
+        std::atomic<Node*> hazard{ nullptr };
+        std::vector<Node*> retired;
+        std::vector<Node*> hazards_snapshot;
+    };
+
+    class RecordLease
+    {
+    public:
+        explicit RecordLease(ConcurrentStack& stack) noexcept : record_(stack.acquire_record()) {}
+
+        RecordLease(const RecordLease&) = delete;
+        RecordLease& operator=(const RecordLease&) = delete;
+
+        ~RecordLease()
+        {
+            record_.hazard.store(nullptr, std::memory_order_release);
+            record_.active.store(false, std::memory_order_release);
+        }
+
+        [[nodiscard]] HazardRecord& record() const noexcept
+        {
+            return record_;
+        }
+
+    private:
+        HazardRecord& record_;
+    };
+
+public:
+    explicit ConcurrentStack(size_t max_threads = default_max_threads(), const Allocator& alloc = Allocator())
+        : record_count_(std::max<size_t>(max_threads, 1))
+        , retire_threshold_(record_count_ * 2 + 16)
+        , records_(std::make_unique<HazardRecord[]>(record_count_))
+        , node_alloc_(alloc)
+    {
+        for (size_t i = 0; i < record_count_; ++i)
+        {
+            // Retired lists never grow past the threshold, so retiring never allocates.
+            records_[i].retired.reserve(retire_threshold_);
+            records_[i].hazards_snapshot.reserve(record_count_);
+        }
+    }
+
+    ConcurrentStack(const ConcurrentStack&) = delete;
+    ConcurrentStack& operator=(const ConcurrentStack&) = delete;
+
+    ~ConcurrentStack()
+    {
+        Node* node = head_.load(std::memory_order_acquire);
+        while (node != nullptr)
+        {
+            destroy_node(std::exchange(node, node->next_node.load(std::memory_order_relaxed)));
+        }
+        for (size_t i = 0; i < record_count_; ++i)
+        {
+            for (Node* retired : records_[i].retired)
+            {
+                destroy_node(retired);
+            }
+        }
+    }
+
+    using value_type = Type;
+    using allocator_type = Allocator;
+
+    [[nodiscard]] static size_t default_max_threads() noexcept
+    {
+        return std::max<size_t>(std::thread::hardware_concurrency(), 1) * 2;
+    }
+
+    // True if the stack was empty at some point during the call.
+    [[nodiscard]] bool empty() const noexcept
+    {
+        return head_.load(std::memory_order_acquire) == nullptr;
+    }
+
+    void push_front(const Type& value)
+    {
+        emplace_front(value);
+    }
+
+    void push_front(Type&& value)
+    {
+        emplace_front(std::move(value));
+    }
+
+    template <typename... Args>
+    void emplace_front(Args&&... args)
+    {
+        Node* node = create_node(std::forward<Args>(args)...);
+        publish(node, node);
+    }
+
+    // Links the whole range off-line and publishes it with a single CAS, so the range
+    // appears on the stack atomically, with *from on top. If copying an element throws,
+    // the stack is left untouched.
+    template <typename InputIterator>
+    void push_range(InputIterator from, InputIterator to)
+    {
+        if (from == to)
+        {
+            return;
+        }
+
+        Node* first = create_node(*from);
+        Node* last = first;
+        try
+        {
+            for (++from; from != to; ++from)
+            {
+                Node* node = create_node(*from);
+                last->next_node.store(node, std::memory_order_relaxed);
+                last = node;
+            }
+        }
+        catch (...)
+        {
+            while (first != nullptr)
+            {
+                destroy_node(std::exchange(first, first->next_node.load(std::memory_order_relaxed)));
+            }
+            throw;
+        }
+        publish(first, last);
+    }
+
+    [[nodiscard]] std::optional<Type> try_pop_front()
+    {
+        RecordLease lease(*this);
+        HazardRecord& record = lease.record();
+
+        Node* top = head_.load(std::memory_order_acquire);
+        while (top != nullptr)
+        {
+            record.hazard.store(top, std::memory_order_seq_cst);
+            if (head_.load(std::memory_order_seq_cst) != top)
+            {
+                top = head_.load(std::memory_order_acquire);
+                continue;
+            }
+
+            Node* next = top->next_node.load(std::memory_order_relaxed);
+            if (head_.compare_exchange_strong(top, next, std::memory_order_seq_cst, std::memory_order_acquire))
+            {
+                break;
+            }
+        }
+        record.hazard.store(nullptr, std::memory_order_release);
+
+        if (top == nullptr)
+        {
+            return std::nullopt;
+        }
+
+        std::optional<Type> result;
+        try
+        {
+            result.emplace(std::move(top->value));
+        }
+        catch (...)
+        {
+            retire(record, top);
+            throw;
+        }
+        retire(record, top);
+        return result;
+    }
+
+    // Detaches every element with one atomic exchange and passes them to func from top
+    // to bottom. Returns the number of elements taken.
+    template <typename Function>
+    size_t pop_all(Function func)
+    {
+        Node* node = head_.exchange(nullptr, std::memory_order_seq_cst);
+        if (node == nullptr)
+        {
+            return 0;
+        }
+
+        RecordLease lease(*this);
+        size_t count = 0;
+        try
+        {
+            for (; node != nullptr; ++count)
+            {
+                Node* next = node->next_node.load(std::memory_order_relaxed);
+                func(std::move(node->value));
+                retire(lease.record(), std::exchange(node, next));
+            }
+        }
+        catch (...)
+        {
+            while (node != nullptr)
+            {
+                retire(lease.record(), std::exchange(node, node->next_node.load(std::memory_order_relaxed)));
+            }
+            throw;
+        }
+        return count;
+    }
+
+    // Detaches every element and returns them as a list, top of the stack first, that
+    // allocates with a copy of the stack's allocator.
+    [[nodiscard]] SingleLinkedList<Type, Allocator> pop_all()
+    {
+        SingleLinkedList<Type, Allocator> result((Allocator(node_alloc_)));
+        auto last = result.before_begin();
+        pop_all([&result, &last](Type&& value) {
+            last = result.emplace_after(last, std::move(value));
+        });
+        return result;
+    }
+
+private:
+    std::atomic<Node*> head_{ nullptr };
+    const size_t record_count_;
+    const size_t retire_threshold_;
+    std::unique_ptr<HazardRecord[]> records_;
+    CUSTOM_LIST_NO_UNIQUE_ADDRESS NodeAllocator node_alloc_;
+
+    [[nodiscard]] static size_t thread_hint() noexcept
+    {
+        static std::atomic<size_t> next_hint{ 0 };
+        thread_local const size_t hint = next_hint.fetch_add(1, std::memory_order_relaxed);
+        return hint;
+    }
+
+    template <typename... Args>
+    Node* create_node(Args&&... args)
+    {
+        Node* node = NodeAllocTraits::allocate(node_alloc_, 1);
+        try
+        {
+            NodeAllocTraits::construct(node_alloc_, node, nullptr, std::forward<Args>(args)...);
+        }
+        catch (...)
+        {
+            NodeAllocTraits::deallocate(node_alloc_, node, 1);
+            throw;
+        }
+        return node;
+    }
+
+    void destroy_node(Node* node) noexcept
+    {
+        NodeAllocTraits::destroy(node_alloc_, node);
+        NodeAllocTraits::deallocate(node_alloc_, node, 1);
+    }
+
+    void publish(Node* first, Node* last) noexcept
+    {
+        Node* top = head_.load(std::memory_order_relaxed);
+        do
+        {
+            last->next_node.store(top, std::memory_order_relaxed);
+        } while (!head_.compare_exchange_weak(top, first, std::memory_order_release, std::memory_order_relaxed));
+    }
+
+    // Starts at a per-thread offset so that threads tend to keep leasing distinct records.
+    HazardRecord& acquire_record() noexcept
+    {
+        const size_t start = thread_hint();
+        for (;;)
+        {
+            for (size_t i = 0; i < record_count_; ++i)
+            {
+                HazardRecord& record = records_[(start + i) % record_count_];
+                if (!record.active.load(std::memory_order_relaxed) && !record.active.exchange(true, std::memory_order_acquire))
+                {
+                    return record;
+                }
+            }
+            std::this_thread::yield();
+        }
+    }
+
+    void retire(HazardRecord& record, Node* node) noexcept
+    {
+        if (record.retired.size() == retire_threshold_)
+        {
+            scan(record);
+        }
+        record.retired.push_back(node);
+    }
+
+    // Frees every retired node that no thread currently holds as a hazard. At most
+    // record_count_ nodes can be protected, so each scan frees at least
+    // retire_threshold_ - record_count_ nodes.
+    void scan(HazardRecord& record) noexcept
+    {
+        std::vector<Node*>& hazards = record.hazards_snapshot;
+        hazards.clear();
+        for (size_t i = 0; i < record_count_; ++i)
+        {
+            if (Node* hazard = records_[i].hazard.load(std::memory_order_seq_cst))
+            {
+                hazards.push_back(hazard);
+            }
+        }
+        std::sort(hazards.begin(), hazards.end());
+
+        const auto still_hazardous = std::partition(record.retired.begin(), record.retired.end(), [&hazards](Node* node) {
+            return std::binary_search(hazards.begin(), hazards.end(), node);
+        });
+        for (auto it = still_hazardous; it != record.retired.end(); ++it)
+        {
+            destroy_node(*it);
+        }
+        record.retired.erase(still_hazardous, record.retired.end());
+    }
+};
@@ -1,31 +1,192 @@
 #pragma once
 #include <cassert>
 #include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <istream>
+#include <limits>
+#include <memory>
+#include <ostream>
 #include <string>
+#include <stdexcept>
+#include <tuple>
+#include <type_traits>
+#include <unordered_map>
 #include <utility>
+#include <vector>
 #include <algorithm>
+#include <array>
+#include <atomic>
+#include <mutex>
+
+#include "list_fingerprint.h"
+#include "list_serialization.h"
+#include "list_stats.h"
+#include "node_reclaimer.h"
+#include "thread_pool.h"
 
 using namespace std;
 
-template <typename Type>
+#if defined(_MSC_VER)
+#define CUSTOM_LIST_NO_UNIQUE_ADDRESS [[msvc::no_unique_address]]
+#else
+#define CUSTOM_LIST_NO_UNIQUE_ADDRESS [[no_unique_address]]
+#endif
+
+// With constexpr allocation (C++20) the core of SingleLinkedList is usable in constant
+// evaluation; before that these members are ordinary inline functions.
+#if defined(__cpp_constexpr_dynamic_alloc) && defined(__cpp_lib_constexpr_dynamic_alloc)
+#define CUSTOM_LIST_CONSTEXPR_CONTAINER 1
+#define CUSTOM_LIST_CONSTEXPR constexpr
+#else
+#define CUSTOM_LIST_CONSTEXPR_CONTAINER 0
+#define CUSTOM_LIST_CONSTEXPR
+#endif
+
+// With the C++20 ranges library, lists can be built from ranges and views, and ToList()
+// collects a view pipeline into a list.
+#if __has_include(<version>)
+#include <version>
+#endif
+#if defined(__cpp_lib_ranges) && __cpp_lib_ranges >= 201911L
+#include <ranges>
+#define CUSTOM_LIST_RANGES 1
+#else
+#define CUSTOM_LIST_RANGES 0
+#endif
+
+#if defined(__GNUC__) || defined(__clang__)
+#define CUSTOM_LIST_PREFETCH(address) __builtin_prefetch((address), 0, 3)
+#elif defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <xmmintrin.h>
+#define CUSTOM_LIST_PREFETCH(address) _mm_prefetch(static_cast<const char*>(address), _MM_HINT_T0)
+#else
+#define CUSTOM_LIST_PREFETCH(address) static_cast<void>(address)
+#endif
+
+// Tail policies for SingleLinkedList. NoTailTracking keeps the list at one head pointer;
+// TailTracking also maintains a pointer to the last node, which enables O(1) push_back,
+// emplace_back, back and append at the cost of one pointer and an update on every relink.
+struct NoTailTracking
+{
+    static constexpr bool tracks_tail = false;
+};
+
+struct TailTracking
+{
+    static constexpr bool tracks_tail = true;
+};
+
+// Inline storage policies for SingleLinkedList. With InlineNodes<N>, N > 0, the list object
+// holds storage for N nodes, which are used before the allocator is asked for any; freed
+// inline slots are reused. Inline nodes cannot change hands by relinking alone, so moves,
+// swap, splice, merge and append move the values of affected inline nodes into nodes owned
+// by the receiving list, invalidating iterators to them. This requires Type to have a
+// nothrow move constructor. N is at most 64.
+template <size_t Capacity>
+struct InlineNodes
+{
+    static constexpr size_t capacity = Capacity;
+};
+
+using NoInlineNodes = InlineNodes<0>;
+
+// Position index policies for SingleLinkedList. With PositionIndex<M>, M > 0, the list can
+// keep a checkpoint index of every M-th node, which takes at(), iterator_at(), advance() and
+// split_at() from O(k) to O(M) steps. The index is dropped by any change to the links and
+// rebuilt in O(n) on the next positional access that reaches past a few checkpoints, so it
+// suits long lists that are read far more often than they are relinked. Each checkpoint
+// costs a pointer and a hash table entry, which lets advance() find its position; both are
+// allocated with std::allocator, outside the list allocator.
+template <size_t Spacing>
+struct PositionIndex
+{
+    static constexpr size_t spacing = Spacing;
+};
+
+using NoPositionIndex = PositionIndex<0>;
+
+#if CUSTOM_LIST_RANGES
+// Tag selecting the range constructor. It is std::from_range_t where the library has it, so
+// that std::ranges::to<SingleLinkedList> uses that constructor too.
+#if defined(__cpp_lib_containers_ranges)
+using FromRangeTag = std::from_range_t;
+inline constexpr FromRangeTag kFromRange = std::from_range;
+#else
+struct FromRangeTag
+{
+    explicit FromRangeTag() = default;
+};
+inline constexpr FromRangeTag kFromRange{};
+#endif
+#endif
+
+template <typename Type, typename Allocator = std::allocator<Type>, typename TailPolicy = NoTailTracking, typename StatsPolicy = NoListStats,
+    typename InlinePolicy = NoInlineNodes, typename FingerprintPolicy = NoFingerprint, typename IndexPolicy = NoPositionIndex>
 class SingleLinkedList
 {
     struct Node
     {
         Node() = default;
-        Node(const Type& val, Node* next) : value(val), next_node(next) {}
+        template <typename... Args>
+        CUSTOM_LIST_CONSTEXPR explicit Node(Node* next, Args&&... args) : value(std::forward<Args>(args)...), next_node(next) {}
 
         Type value{};
         Node* next_node = nullptr;
     };
 
+    using NodeAllocator = typename std::allocator_traits<Allocator>::template rebind_alloc<Node>;
+    using NodeAllocTraits = std::allocator_traits<NodeAllocator>;
+
+    static constexpr bool kTracksTail = TailPolicy::tracks_tail;
+
+    struct NoTail {};
+    using TailStorage = std::conditional_t<kTracksTail, Node*, NoTail>;
+
+    static constexpr bool kStats = StatsPolicy::enabled;
+
+    struct NoStats {};
+    using StatsStorage = std::conditional_t<kStats, ListStatistics, NoStats>;
+
+    static constexpr size_t kInlineCapacity = InlinePolicy::capacity;
+
+    static_assert(kInlineCapacity <= 64, "at most 64 inline nodes are supported");
+    static_assert(kInlineCapacity == 0 || std::is_nothrow_move_constructible_v<Type>,
+        "inline nodes require a nothrow move constructor");
+
+    struct NoInlineSlots {};
+    struct InlineSlots
+    {
+        alignas(Node) unsigned char storage[std::max<size_t>(kInlineCapacity, 1) * sizeof(Node)];
+        uint64_t free_mask = kInlineCapacity == 64 ? ~uint64_t{ 0 } : (uint64_t{ 1 } << kInlineCapacity) - 1;
+        size_t used = 0;
+    };
+    using InlineStorage = std::conditional_t<(kInlineCapacity > 0), InlineSlots, NoInlineSlots>;
+
+    static constexpr bool kFingerprint = FingerprintPolicy::enabled;
+
+    struct NoFingerprintValue {};
+    using FingerprintStorage = std::conditional_t<kFingerprint, uint64_t, NoFingerprintValue>;
+
+    static constexpr size_t kIndexSpacing = IndexPolicy::spacing;
+
+    struct NoIndex {};
+    struct Checkpoints
+    {
+        // nodes[i] is the node at position i * kIndexSpacing; positions maps it back to that.
+        std::vector<Node*> nodes;
+        std::unordered_map<const Node*, size_t> positions;
+        bool valid = false;
+    };
+    using IndexStorage = std::conditional_t<(kIndexSpacing > 0), Checkpoints, NoIndex>;
+
     template <typename ValueType>
     class BasicIterator
     {
 
         friend class SingleLinkedList;
 
-        explicit BasicIterator(Node* node) : node_(node) {}
+        CUSTOM_LIST_CONSTEXPR explicit BasicIterator(Node* node) : node_(node) {}
 
     public:
 
@@ -37,32 +198,32 @@ class SingleLinkedList
 
         BasicIterator() = default;
 
-        BasicIterator(const BasicIterator<Type>& other) noexcept : node_(other.node_) {}
+        CUSTOM_LIST_CONSTEXPR BasicIterator(const BasicIterator<Type>& other) noexcept : node_(other.node_) {}
 
         BasicIterator& operator=(const BasicIterator& rhs) = default;
 
 
-        [[nodiscard]] bool operator==(const BasicIterator<const Type>& rhs) const noexcept
+        [[nodiscard]] CUSTOM_LIST_CONSTEXPR bool operator==(const BasicIterator<const Type>& rhs) const noexcept
         {
             return this->node_ == rhs.node_;
         }
 
-        [[nodiscard]] bool operator!=(const BasicIterator<const Type>& rhs) const noexcept
+        [[nodiscard]] CUSTOM_LIST_CONSTEXPR bool operator!=(const BasicIterator<const Type>& rhs) const noexcept
         {
             return !(this->node_ == rhs.node_);
         }
 
-        [[nodiscard]] bool operator==(const BasicIterator<Type>& rhs) const noexcept
+        [[nodiscard]] CUSTOM_LIST_CONSTEXPR bool operator==(const BasicIterator<Type>& rhs) const noexcept
         {
             return this->node_ == rhs.node_;
         }
 
-        [[nodiscard]] bool operator!=(const BasicIterator<Type>& rhs) const noexcept
+        [[nodiscard]] CUSTOM_LIST_CONSTEXPR bool operator!=(const BasicIterator<Type>& rhs) const noexcept
         {
             return !(this->node_ == rhs.node_);
         }
 
-        BasicIterator& operator++() noexcept
+        CUSTOM_LIST_CONSTEXPR BasicIterator& operator++() noexcept
         {
             assert(node_ != nullptr);
 
@@ -70,7 +231,7 @@ class SingleLinkedList
             return *this;
         }
 
-        BasicIterator operator++(int) noexcept
+        CUSTOM_LIST_CONSTEXPR BasicIterator operator++(int) noexcept
         {
             assert(node_ != nullptr);
 
@@ -79,14 +240,14 @@ class SingleLinkedList
             return old_value;
         }
 
-        [[nodiscard]] reference operator*() const noexcept
+        [[nodiscard]] CUSTOM_LIST_CONSTEXPR reference operator*() const noexcept
         {
             assert(node_ != nullptr);
 
             return node_->value;
         }
 
-        [[nodiscard]] pointer operator->() const noexcept
+        [[nodiscard]] CUSTOM_LIST_CONSTEXPR pointer operator->() const noexcept
         {
             assert(node_ != nullptr);
 
@@ -98,99 +259,287 @@ class SingleLinkedList
     };
 
 public:
-    SingleLinkedList() {}
+    CUSTOM_LIST_CONSTEXPR SingleLinkedList() {}
+
+    CUSTOM_LIST_CONSTEXPR explicit SingleLinkedList(const Allocator& alloc) : node_alloc_(alloc) {}
 
-    SingleLinkedList(std::initializer_list<Type> values)
+    CUSTOM_LIST_CONSTEXPR SingleLinkedList(std::initializer_list<Type> values, const Allocator& alloc = Allocator()) : node_alloc_(alloc)
     {
-        assign(values.begin(), values.end());
+        rebuild(values.begin(), values.end());
+    }
+
+    template <typename InputIterator, typename = typename std::iterator_traits<InputIterator>::iterator_category>
+    CUSTOM_LIST_CONSTEXPR SingleLinkedList(InputIterator first, InputIterator last, const Allocator& alloc = Allocator()) : node_alloc_(alloc)
+    {
+        rebuild(first, last);
+    }
+
+#if CUSTOM_LIST_RANGES
+    // Builds the list in one pass over range, which may be a lazy view whose end is a sentinel
+    // of another type; nothing is allocated besides the nodes.
+    template <std::ranges::input_range Range>
+        requires std::convertible_to<std::ranges::range_reference_t<Range>, Type>
+    CUSTOM_LIST_CONSTEXPR SingleLinkedList(FromRangeTag, Range&& range, const Allocator& alloc = Allocator()) : node_alloc_(alloc)
+    {
+        rebuild(std::ranges::begin(range), std::ranges::end(range));
     }
+#endif
 
-    SingleLinkedList(const SingleLinkedList& other)
+    CUSTOM_LIST_CONSTEXPR SingleLinkedList(const SingleLinkedList& other)
+        : node_alloc_(NodeAllocTraits::select_on_container_copy_construction(other.node_alloc_))
     {
         assert(size_ == 0 && head_.next_node == nullptr);
 
-        assign(other.begin(), other.end());
+        rebuild(other.begin(), other.end());
+    }
+
+    CUSTOM_LIST_CONSTEXPR SingleLinkedList(SingleLinkedList&& other) noexcept : node_alloc_(std::move(other.node_alloc_))
+    {
+        steal_nodes(other);
+        record_size();
     }
 
-    ~SingleLinkedList()
+    CUSTOM_LIST_CONSTEXPR ~SingleLinkedList()
     {
         clear();
     }
 
     using value_type = Type;
+    using allocator_type = Allocator;
     using reference = value_type&;
     using const_reference = const value_type&;
     using Iterator = BasicIterator<Type>;
     using ConstIterator = BasicIterator<const Type>;
 
-    [[nodiscard]] Iterator begin() noexcept
+    [[nodiscard]] CUSTOM_LIST_CONSTEXPR allocator_type get_allocator() const noexcept
+    {
+        return allocator_type(node_alloc_);
+    }
+
+    [[nodiscard]] CUSTOM_LIST_CONSTEXPR Iterator begin() noexcept
     {
         return Iterator{ head_.next_node };
     }
 
-    [[nodiscard]] Iterator end() noexcept
+    [[nodiscard]] CUSTOM_LIST_CONSTEXPR Iterator end() noexcept
     {
         return Iterator{ nullptr };
     }
 
-    [[nodiscard]] ConstIterator begin() const noexcept
+    [[nodiscard]] CUSTOM_LIST_CONSTEXPR ConstIterator begin() const noexcept
     {
         return cbegin();
     }
 
-    [[nodiscard]] ConstIterator end() const noexcept
+    [[nodiscard]] CUSTOM_LIST_CONSTEXPR ConstIterator end() const noexcept
     {
         return cend();
     }
 
-    [[nodiscard]] ConstIterator cbegin() const noexcept
+    [[nodiscard]] CUSTOM_LIST_CONSTEXPR ConstIterator cbegin() const noexcept
     {
         return ConstIterator{ head_.next_node };
     }
 
-    [[nodiscard]] ConstIterator cend() const noexcept
+    [[nodiscard]] CUSTOM_LIST_CONSTEXPR ConstIterator cend() const noexcept
     {
         return ConstIterator{ nullptr };
     }
 
-    [[nodiscard]] Iterator before_begin() noexcept
+    [[nodiscard]] CUSTOM_LIST_CONSTEXPR Iterator before_begin() noexcept
     {
         return Iterator{ &head_ };
     }
 
-    [[nodiscard]] ConstIterator cbefore_begin() const noexcept
+    [[nodiscard]] CUSTOM_LIST_CONSTEXPR ConstIterator cbefore_begin() const noexcept
     {
         return ConstIterator{ const_cast<Node*>(&head_) };
     }
 
-    [[nodiscard]] ConstIterator before_begin() const noexcept
+    [[nodiscard]] CUSTOM_LIST_CONSTEXPR ConstIterator before_begin() const noexcept
     {
         return cbefore_begin();
     }
 
-    Iterator insert(ConstIterator pos, const Type& value)
+    CUSTOM_LIST_CONSTEXPR Iterator insert(ConstIterator pos, const Type& value)
+    {
+        assert(pos.node_ != nullptr);
+
+        return emplace_after(pos, value);
+    }
+
+    CUSTOM_LIST_CONSTEXPR Iterator insert(ConstIterator pos, Type&& value)
+    {
+        return emplace_after(pos, std::move(value));
+    }
+
+    template <typename... Args>
+    CUSTOM_LIST_CONSTEXPR Iterator emplace_after(ConstIterator pos, Args&&... args)
     {
         assert(pos.node_ != nullptr);
 
-        pos.node_->next_node = new Node(value, pos.node_->next_node);
+        record_insert(pos.node_);
+        pos.node_->next_node = create_node(pos.node_->next_node, std::forward<Args>(args)...);
         ++size_;
+        record_size();
+        relinked(pos.node_->next_node);
+        fingerprint_linked(pos.node_, pos.node_->next_node, 0);
         return Iterator{ pos.node_->next_node };
     }
 
-    Iterator erase(ConstIterator pos) noexcept
+    // Insert copies of a range, or count copies of value, after pos, and return an iterator
+    // to the last inserted element, or pos if none was. The new nodes are built into a chain
+    // off to the side in one pass and linked in with one pointer write and one size update;
+    // if building the chain throws, the chain is freed and the list is unchanged.
+    template <typename InputIterator, typename = typename std::iterator_traits<InputIterator>::iterator_category>
+    CUSTOM_LIST_CONSTEXPR Iterator insert_after(ConstIterator pos, InputIterator first, InputIterator last)
+    {
+        assert(pos.node_ != nullptr);
+
+        const Chain chain = make_chain(first, last);
+        record_insert(pos.node_);
+        return Iterator{ link_chain(pos.node_, chain) };
+    }
+
+    CUSTOM_LIST_CONSTEXPR Iterator insert_after(ConstIterator pos, size_t count, const Type& value)
+    {
+        assert(pos.node_ != nullptr);
+
+        const Chain chain = make_chain(count, [&value]() -> const Type& {
+            return value;
+        });
+        record_insert(pos.node_);
+        return Iterator{ link_chain(pos.node_, chain) };
+    }
+
+    CUSTOM_LIST_CONSTEXPR Iterator insert_after(ConstIterator pos, std::initializer_list<Type> values)
+    {
+        return insert_after(pos, values.begin(), values.end());
+    }
+
+    CUSTOM_LIST_CONSTEXPR Iterator erase(ConstIterator pos) noexcept
     {
         assert(!empty());
         assert(pos.node_ != nullptr);
 
+        record_erase(pos.node_);
+        fingerprint_unlinking(pos.node_, pos.node_->next_node);
         auto temp = pos.node_->next_node->next_node;
-        delete pos.node_->next_node;
+        destroy_node(pos.node_->next_node);
         pos.node_->next_node = temp;
         --size_;
+        relinked(pos.node_);
 
         return Iterator{ pos.node_->next_node };
     }
 
-    SingleLinkedList& operator=(const SingleLinkedList& rhs)
+    // Erases the elements in the open range (first, last) and returns last. The range is
+    // unlinked with one pointer write, then its nodes are freed in one walk that also counts them.
+    CUSTOM_LIST_CONSTEXPR Iterator erase_after(ConstIterator first, ConstIterator last) noexcept
+    {
+        assert(first.node_ != nullptr);
+
+        Node* node = first.node_->next_node;
+        if (node == last.node_)
+        {
+            return Iterator{ last.node_ };
+        }
+
+        record_erase(first.node_);
+        if constexpr (kFingerprint)
+        {
+            Node* range_last = node;
+            while (range_last->next_node != last.node_)
+            {
+                range_last = range_last->next_node;
+            }
+            fingerprint_unlinking(first.node_, range_last);
+        }
+        first.node_->next_node = last.node_;
+        relinked(first.node_);
+        while (node != last.node_)
+        {
+            destroy_node(std::exchange(node, node->next_node));
+            --size_;
+        }
+        return Iterator{ last.node_ };
+    }
+
+    // Bulk removal in a single pass. Removed nodes are unlinked and freed in batches of up to
+    // kRemovalBatch, while they are likely still in cache, rather than one per unlink. The
+    // element value refers to, if it is in the list, is freed last. Each returns the number
+    // of elements removed; if pred throws, the elements removed so far stay removed.
+    size_t remove(const Type& value)
+    {
+        RemovalBatch removed(*this, &value);
+        remove_nodes(removed, [&value](const Type& element) {
+            return element == value;
+        });
+        return removed.count();
+    }
+
+    template <typename Predicate>
+    size_t remove_if(Predicate pred)
+    {
+        RemovalBatch removed(*this);
+        remove_nodes(removed, pred);
+        return removed.count();
+    }
+
+    // Removes every element for which pred(kept, element) holds, kept being the last element
+    // before it that was not removed; with the default, consecutive duplicates.
+    template <typename BinaryPredicate>
+    size_t unique(BinaryPredicate pred)
+    {
+        if (size_ < 2)
+        {
+            return 0;
+        }
+
+        RemovalBatch removed(*this);
+        Node* prev = head_.next_node;
+        while (prev->next_node != nullptr)
+        {
+            if (pred(prev->value, prev->next_node->value))
+            {
+                removed.unlink_after(prev);
+            }
+            else
+            {
+                prev = prev->next_node;
+            }
+        }
+        relinked(prev);
+        return removed.count();
+    }
+
+    size_t unique()
+    {
+        return unique(std::equal_to<>{});
+    }
+
+    // Reverses the order of the elements by relinking; no element is copied or moved.
+    CUSTOM_LIST_CONSTEXPR void reverse() noexcept
+    {
+        Node* reversed = nullptr;
+        Node* node = head_.next_node;
+        Node* const first = node;
+        while (node != nullptr)
+        {
+            Node* next = node->next_node;
+            node->next_node = reversed;
+            reversed = node;
+            node = next;
+        }
+        head_.next_node = reversed;
+        if (first != nullptr)
+        {
+            relinked(first);
+        }
+        refresh_fingerprint();
+    }
+
+    CUSTOM_LIST_CONSTEXPR SingleLinkedList& operator=(const SingleLinkedList& rhs)
     {
         if (this != &rhs) 
         {
@@ -198,121 +547,1994 @@ public:
             {
                 clear();
             }
-            SingleLinkedList rhs_copy(rhs);
-            swap(rhs_copy);
+            SingleLinkedList rhs_copy(NodeAllocTraits::propagate_on_container_copy_assignment::value ? rhs.node_alloc_ : node_alloc_);
+            rhs_copy.link_chain(&rhs_copy.head_, rhs_copy.make_chain(rhs.begin(), rhs.end()));
+            commit(rhs_copy);
+        }
+        return *this;
+    }
+
+    CUSTOM_LIST_CONSTEXPR SingleLinkedList& operator=(SingleLinkedList&& rhs) noexcept(
+        NodeAllocTraits::propagate_on_container_move_assignment::value || NodeAllocTraits::is_always_equal::value)
+    {
+        if (this != &rhs)
+        {
+            if constexpr (NodeAllocTraits::propagate_on_container_move_assignment::value)
+            {
+                clear();
+                node_alloc_ = std::move(rhs.node_alloc_);
+                steal_nodes(rhs);
+            }
+            else if (NodeAllocTraits::is_always_equal::value || node_alloc_ == rhs.node_alloc_)
+            {
+                clear();
+                steal_nodes(rhs);
+            }
+            else
+            {
+                // Nodes cannot change hands between unequal allocators, so move the values instead.
+                assign(std::make_move_iterator(rhs.begin()), std::make_move_iterator(rhs.end()));
+                rhs.clear();
+            }
         }
         return *this;
     }
 
-    void swap(SingleLinkedList& other) noexcept
+    // Replace the contents, assigning to the values of existing nodes first, then erasing
+    // surplus nodes or inserting the missing elements as insert_after does. Provides the
+    // basic exception guarantee; value must not refer to an element of this list.
+    template <typename InputIterator, typename = typename std::iterator_traits<InputIterator>::iterator_category>
+    CUSTOM_LIST_CONSTEXPR void assign(InputIterator first, InputIterator last)
+    {
+        [[maybe_unused]] FingerprintRefresh refresh{ *this };
+        Node* prev = &head_;
+        for (; prev->next_node != nullptr && first != last; ++first)
+        {
+            prev = prev->next_node;
+            prev->value = *first;
+        }
+        truncate_after(prev);
+        link_chain(prev, make_chain(first, last));
+    }
+
+    CUSTOM_LIST_CONSTEXPR void assign(size_t count, const Type& value)
     {
-        std::swap(other.head_.next_node, head_.next_node);
-        std::swap(other.size_, size_);
+        [[maybe_unused]] FingerprintRefresh refresh{ *this };
+        Node* prev = &head_;
+        for (; prev->next_node != nullptr && count > 0; --count)
+        {
+            prev = prev->next_node;
+            prev->value = value;
+        }
+        truncate_after(prev);
+        link_chain(prev, make_chain(count, [&value]() -> const Type& {
+            return value;
+        }));
+    }
+
+    CUSTOM_LIST_CONSTEXPR void assign(std::initializer_list<Type> values)
+    {
+        assign(values.begin(), values.end());
+    }
+
+    CUSTOM_LIST_CONSTEXPR void swap(SingleLinkedList& other) noexcept
+    {
+        if constexpr (NodeAllocTraits::propagate_on_container_swap::value)
+        {
+            std::swap(other.node_alloc_, node_alloc_);
+        }
+        else
+        {
+            assert(other.node_alloc_ == node_alloc_);
+        }
+        swap_contents(other);
     }
 
-    [[nodiscard]] size_t size() const noexcept
+    [[nodiscard]] CUSTOM_LIST_CONSTEXPR size_t size() const noexcept
     {
         return size_;
     }
 
-    [[nodiscard]] bool empty() const noexcept
+    [[nodiscard]] CUSTOM_LIST_CONSTEXPR bool empty() const noexcept
     {
         return size_ == 0;
     }
 
-    void push_front(const Type& value)
+    CUSTOM_LIST_CONSTEXPR void push_front(const Type& value)
+    {
+        emplace_front(value);
+    }
+
+    CUSTOM_LIST_CONSTEXPR void push_front(Type&& value)
     {
-        head_.next_node = new Node(value, head_.next_node);
+        emplace_front(std::move(value));
+    }
+
+    template <typename... Args>
+    CUSTOM_LIST_CONSTEXPR reference emplace_front(Args&&... args)
+    {
+        record_insert(&head_);
+        head_.next_node = create_node(head_.next_node, std::forward<Args>(args)...);
         ++size_;
+        record_size();
+        relinked(head_.next_node);
+        fingerprint_linked(&head_, head_.next_node, 0);
+        return head_.next_node->value;
+    }
+
+    // Tail-tracking lists only: O(1) insertion at, and access to, the end of the list.
+    CUSTOM_LIST_CONSTEXPR void push_back(const Type& value)
+    {
+        emplace_back(value);
+    }
+
+    CUSTOM_LIST_CONSTEXPR void push_back(Type&& value)
+    {
+        emplace_back(std::move(value));
+    }
+
+    template <typename... Args>
+    CUSTOM_LIST_CONSTEXPR reference emplace_back(Args&&... args)
+    {
+        static_assert(kTracksTail, "emplace_back requires TailTracking");
+
+        return *emplace_after(before_end(), std::forward<Args>(args)...);
+    }
+
+    [[nodiscard]] CUSTOM_LIST_CONSTEXPR reference back() noexcept
+    {
+        static_assert(kTracksTail, "back requires TailTracking");
+        assert(!empty());
+
+        return tail_->value;
+    }
+
+    [[nodiscard]] CUSTOM_LIST_CONSTEXPR const_reference back() const noexcept
+    {
+        static_assert(kTracksTail, "back requires TailTracking");
+        assert(!empty());
+
+        return tail_->value;
+    }
+
+    // Iterator to the last element, or before_begin() if the list is empty; inserting
+    // after it appends. Tail-tracking lists only.
+    [[nodiscard]] CUSTOM_LIST_CONSTEXPR Iterator before_end() noexcept
+    {
+        static_assert(kTracksTail, "before_end requires TailTracking");
+
+        return Iterator{ last_node() };
+    }
+
+    [[nodiscard]] CUSTOM_LIST_CONSTEXPR ConstIterator before_end() const noexcept
+    {
+        static_assert(kTracksTail, "before_end requires TailTracking");
+
+        return ConstIterator{ last_node() };
+    }
+
+    // Moves all elements of other to the end of this list in O(1) by relinking. Tail-tracking
+    // lists only; as with splice_after, both lists must use equal allocators.
+    void append(SingleLinkedList&& other) noexcept(kInlineCapacity == 0)
+    {
+        static_assert(kTracksTail, "append requires TailTracking");
+
+        splice_after(before_end(), other);
     }
 
-    void clear() noexcept
+    CUSTOM_LIST_CONSTEXPR void clear() noexcept
     {
         while (head_.next_node)
         {
             Node* new_head = head_.next_node->next_node;
-            delete head_.next_node;
+            destroy_node(head_.next_node);
             head_.next_node = new_head;
         }
         size_ = 0;
+        relinked(&head_);
+        fingerprint_ = empty_fingerprint();
+    }
+
+    // Detaches all nodes in O(1) and hands them to reclaimer, which destroys and frees them
+    // in batches on its thread; the list is empty and usable on return. A list no longer than
+    // one batch is cleared on the spot, as is any list if the job cannot be queued. Element
+    // destructors and a copy of the allocator then run on the reclaimer thread, so both must
+    // allow that. With ListStats the deallocations are counted here. Not available with
+    // inline nodes, which live in the list object.
+    void clear_async(NodeReclaimer& reclaimer = NodeReclaimer::shared()) noexcept
+    {
+        static_assert(kInlineCapacity == 0, "clear_async requires a list without inline nodes");
+
+        if (size_ <= reclaimer.batch_size())
+        {
+            clear();
+            return;
+        }
+
+        Node* chain = head_.next_node;
+        try
+        {
+            reclaimer.submit([alloc = node_alloc_, chain](size_t batch_size) mutable noexcept {
+                return free_chain(alloc, chain, batch_size);
+            });
+        }
+        catch (...)
+        {
+            clear();
+            return;
+        }
+        const size_t count = std::exchange(size_, 0);
+        head_.next_node = nullptr;
+        relinked(&head_);
+        fingerprint_ = empty_fingerprint();
+        record_stats([count](auto& stats) {
+            stats.record_deallocations(count);
+        });
     }
 
-    void pop_front() noexcept
+    CUSTOM_LIST_CONSTEXPR void pop_front() noexcept
     {
         assert(!empty());
 
+        record_erase(&head_);
+        fingerprint_unlinking(&head_, head_.next_node);
         auto new_head = head_.next_node->next_node;
-        delete head_.next_node;
+        destroy_node(head_.next_node);
         head_.next_node = new_head;
         --size_;
+        relinked(&head_);
     }
 
-private:
+    // Moves all elements of other after pos. Only pointers are relinked; no element is copied
+    // or allocated, so both lists must use equal allocators. Takes constant time if the lists
+    // track their tail and time linear in the size of other otherwise.
+    void splice_after(ConstIterator pos, SingleLinkedList& other) noexcept(kInlineCapacity == 0)
+    {
+        assert(pos.node_ != nullptr);
+        assert(this != &other);
+        assert(node_alloc_ == other.node_alloc_);
 
-    Node head_;
-    size_t size_ = 0;
+        if (other.empty())
+        {
+            return;
+        }
+
+        adopt_inline_nodes(other, &other.head_, nullptr);
+        Node* first = other.head_.next_node;
+        Node* last = other.last_node();
+        // The links inside the moved chain are all of other's links but the outer two.
+        uint64_t inner_links = 0;
+        if constexpr (kFingerprint)
+        {
+            inner_links = other.fingerprint_ - list_fingerprint::LinkHash(list_fingerprint::kBeginKey, fingerprint_key(first)) -
+                list_fingerprint::LinkHash(fingerprint_key(last), list_fingerprint::kEndKey);
+        }
 
-    template <typename InputIterator>
-    void assign(InputIterator from, InputIterator to)
+        last->next_node = pos.node_->next_node;
+        pos.node_->next_node = first;
+        size_ += other.size_;
+        record_size();
+        relinked(last);
+        fingerprint_linked(pos.node_, last, inner_links);
+        other.head_.next_node = nullptr;
+        other.size_ = 0;
+        other.relinked(&other.head_);
+        other.fingerprint_ = empty_fingerprint();
+    }
+
+    void splice_after(ConstIterator pos, SingleLinkedList&& other) noexcept(kInlineCapacity == 0)
     {
-        SingleLinkedList<Type> tmp;
-        Node** node_ptr = &tmp.head_.next_node;
+        splice_after(pos, other);
+    }
 
-        while (from != to)
-        {
-            assert(*node_ptr == nullptr);
+    // Moves the element following it from other to the position after pos.
+    void splice_after(ConstIterator pos, SingleLinkedList& other, ConstIterator it) noexcept(kInlineCapacity == 0)
+    {
+        assert(pos.node_ != nullptr && it.node_ != nullptr && it.node_->next_node != nullptr);
+        assert(node_alloc_ == other.node_alloc_);
 
-            *node_ptr = new Node(*from, nullptr);
-            ++tmp.size_;
-            node_ptr = &((*node_ptr)->next_node);
-            ++from;
+        if (pos.node_ == it.node_ || pos.node_ == it.node_->next_node)
+        {
+            return;
         }
-        swap(tmp);
+
+        Node* node = this == &other ? it.node_->next_node : adopt_inline_nodes(other, it.node_, it.node_->next_node);
+
+        other.fingerprint_unlinking(it.node_, node);
+        it.node_->next_node = node->next_node;
+        node->next_node = pos.node_->next_node;
+        pos.node_->next_node = node;
+        --other.size_;
+        ++size_;
+        record_size();
+        other.relinked(it.node_);
+        relinked(node);
+        fingerprint_linked(pos.node_, node, 0);
     }
-};
 
-template <typename Type>
-void swap(SingleLinkedList<Type>& lhs, SingleLinkedList<Type>& rhs) noexcept
-{
-    lhs.swap(rhs);
-}
+    void splice_after(ConstIterator pos, SingleLinkedList&& other, ConstIterator it) noexcept(kInlineCapacity == 0)
+    {
+        splice_after(pos, other, it);
+    }
 
-template <typename Type>
-bool operator==(const SingleLinkedList<Type>& lhs, const SingleLinkedList<Type>& rhs)
-{
-    if (&lhs == &rhs || lhs.size() == rhs.size() || std::equal(lhs.begin(), lhs.end(), rhs.begin()))
+    // Moves the elements in the open range (first, last) from other to the position after pos.
+    // Takes time linear in the length of the range, which is walked to keep size() exact.
+    void splice_after(ConstIterator pos, SingleLinkedList& other, ConstIterator first, ConstIterator last) noexcept(kInlineCapacity == 0)
     {
-        return true;
+        assert(pos.node_ != nullptr && first.node_ != nullptr);
+        assert(node_alloc_ == other.node_alloc_);
+
+        if (first.node_->next_node == last.node_)
+        {
+            return;
+        }
+
+        Node* range_last = first.node_->next_node;
+        size_t count = 1;
+        while (range_last->next_node != last.node_)
+        {
+            assert(range_last != pos.node_);
+
+            range_last = range_last->next_node;
+            ++count;
+        }
+        if (this != &other)
+        {
+            range_last = adopt_inline_nodes(other, first.node_, range_last);
+        }
+
+        Node* range_first = first.node_->next_node;
+        const uint64_t inner_links = other.fingerprint_unlinking(first.node_, range_last);
+        first.node_->next_node = last.node_;
+        range_last->next_node = pos.node_->next_node;
+        pos.node_->next_node = range_first;
+        other.size_ -= count;
+        size_ += count;
+        record_size();
+        other.relinked(first.node_);
+        relinked(range_last);
+        fingerprint_linked(pos.node_, range_last, inner_links);
     }
-    return false;
-}
 
-template <typename Type>
-bool operator!=(const SingleLinkedList<Type>& lhs, const SingleLinkedList<Type>& rhs)
-{
-    return !(lhs == rhs);
-}
+    void splice_after(ConstIterator pos, SingleLinkedList&& other, ConstIterator first, ConstIterator last) noexcept(kInlineCapacity == 0)
+    {
+        splice_after(pos, other, first, last);
+    }
 
-template <typename Type>
-bool operator<(const SingleLinkedList<Type>& lhs, const SingleLinkedList<Type>& rhs)
-{
-    return std::lexicographical_compare(lhs.begin(), lhs.end(), rhs.begin(), rhs.end());
-}
+    // Merges the sorted list other into this sorted list. Stable: of equivalent elements,
+    // those already in this list come first.
+    template <typename Compare>
+    CUSTOM_LIST_CONSTEXPR void merge(SingleLinkedList& other, Compare comp)
+    {
+        assert(node_alloc_ == other.node_alloc_);
 
-template <typename Type>
-bool operator<=(const SingleLinkedList<Type>& lhs, const SingleLinkedList<Type>& rhs)
-{
-    return !(lhs > rhs);
-}
+        if (this == &other)
+        {
+            return;
+        }
 
-template <typename Type>
-bool operator>(const SingleLinkedList<Type>& lhs, const SingleLinkedList<Type>& rhs)
-{
-    return rhs < lhs;
-}
+        adopt_inline_nodes(other, &other.head_, nullptr);
+        Node* left = std::exchange(head_.next_node, nullptr);
+        Node* right = std::exchange(other.head_.next_node, nullptr);
+        // If comp throws, every node of other has still moved here; the order may be wrong.
+        Node* last = &head_;
+        try
+        {
+            last = merge_chains(&head_, left, right, comp);
+        }
+        catch (...)
+        {
+            finish_merge(other, chain_end(&head_));
+            throw;
+        }
+        finish_merge(other, last);
+    }
 
-template <typename Type>
-bool operator>=(const SingleLinkedList<Type>& lhs, const SingleLinkedList<Type>& rhs)
-{
-    return !(lhs < rhs);
-}
\ No newline at end of file
+    template <typename Compare>
+    CUSTOM_LIST_CONSTEXPR void merge(SingleLinkedList&& other, Compare comp)
+    {
+        merge(other, comp);
+    }
+
+    CUSTOM_LIST_CONSTEXPR void merge(SingleLinkedList& other)
+    {
+        merge(other, std::less<>{});
+    }
+
+    CUSTOM_LIST_CONSTEXPR void merge(SingleLinkedList&& other)
+    {
+        merge(other, std::less<>{});
+    }
+
+    // Stable bottom-up merge sort: runs of width 1, 2, 4, ... are merged pairwise by relinking
+    // nodes, so the sort takes O(n log n) time and O(1) extra space. If comp throws, the list
+    // keeps all its elements in an unspecified order.
+    template <typename Compare>
+    CUSTOM_LIST_CONSTEXPR void sort(Compare comp)
+    {
+        Node* rest = nullptr;
+        try
+        {
+            for (size_t width = 1; width < size_; width *= 2)
+            {
+                Node* tail = &head_;
+                rest = std::exchange(head_.next_node, nullptr);
+                while (rest != nullptr)
+                {
+                    Node* left = rest;
+                    Node* right = cut_after(left, width);
+                    rest = cut_after(right, width);
+                    tail = merge_chains(tail, left, right, comp);
+                }
+                relinked(tail);
+            }
+        }
+        catch (...)
+        {
+            // The runs not yet merged in this pass go back after the merged part.
+            Node* last = chain_end(&head_);
+            last->next_node = rest;
+            relinked(chain_end(last));
+            refresh_fingerprint();
+            throw;
+        }
+        refresh_fingerprint();
+    }
+
+    CUSTOM_LIST_CONSTEXPR void sort()
+    {
+        sort(std::less<>{});
+    }
+
+    // Bulk traversal algorithms. Unlike a loop over iterators, they walk the nodes with a
+    // second cursor running prefetch_distance nodes ahead that prefetches each node it
+    // reaches, so the memory latency of upcoming nodes overlaps with work on the current one.
+    // A distance of 0 disables prefetching.
+    static constexpr size_t default_prefetch_distance = 8;
+
+    template <typename Function>
+    Function for_each(Function func, size_t prefetch_distance = default_prefetch_distance)
+    {
+        [[maybe_unused]] FingerprintRefresh refresh{ *this };
+        visit_nodes(head_.next_node, prefetch_distance, [&func](Type& value) {
+            func(value);
+            return true;
+        });
+        return func;
+    }
+
+    template <typename Function>
+    Function for_each(Function func, size_t prefetch_distance = default_prefetch_distance) const
+    {
+        visit_nodes(head_.next_node, prefetch_distance, [&func](const Type& value) {
+            func(value);
+            return true;
+        });
+        return func;
+    }
+
+    // Left fold in list order.
+    template <typename T, typename BinaryOperation = std::plus<>>
+    [[nodiscard]] T accumulate(T init, BinaryOperation op = {}, size_t prefetch_distance = default_prefetch_distance) const
+    {
+        visit_nodes(head_.next_node, prefetch_distance, [&init, &op](const Type& value) {
+            init = op(std::move(init), value);
+            return true;
+        });
+        return init;
+    }
+
+    // Like accumulate, but op must be associative and commutative, which lets the parallel
+    // overloads combine segments in any order.
+    template <typename T, typename BinaryOperation = std::plus<>>
+    [[nodiscard]] T reduce(T init, BinaryOperation op = {}, size_t prefetch_distance = default_prefetch_distance) const
+    {
+        return accumulate(std::move(init), std::move(op), prefetch_distance);
+    }
+
+    template <typename Predicate>
+    [[nodiscard]] size_t count_if(Predicate pred, size_t prefetch_distance = default_prefetch_distance) const
+    {
+        size_t count = 0;
+        visit_nodes(head_.next_node, prefetch_distance, [&count, &pred](const Type& value) {
+            if (pred(value))
+            {
+                ++count;
+            }
+            return true;
+        });
+        return count;
+    }
+
+    // Replaces every value with op(value).
+    template <typename UnaryOperation>
+    void transform_inplace(UnaryOperation op, size_t prefetch_distance = default_prefetch_distance)
+    {
+        [[maybe_unused]] FingerprintRefresh refresh{ *this };
+        visit_nodes(head_.next_node, prefetch_distance, [&op](Type& value) {
+            value = op(std::move(value));
+            return true;
+        });
+    }
+
+    // Overloads taking an execution policy. With ParallelPolicy the list is cut into segments
+    // of about equal length in a single walk; since size() is known, the boundaries follow
+    // from the segment count, and each segment is handed to the pool as soon as the walk
+    // reaches its end. func, op and pred are then called concurrently on distinct elements.
+    // The parallel reduce seeds each segment with its first value, so T must be constructible
+    // from const Type&, and combines the segment results in unspecified order. The first
+    // exception thrown by a segment is rethrown once all segments have finished.
+    template <typename Function>
+    void for_each(const SequencedPolicy&, Function func)
+    {
+        for_each(std::move(func));
+    }
+
+    template <typename Function>
+    void for_each(const ParallelPolicy& policy, Function func)
+    {
+        [[maybe_unused]] FingerprintRefresh refresh{ *this };
+        visit_segments(policy, [&func](Node* first, size_t count) {
+            visit_segment(first, count, [&func](Type& value) {
+                func(value);
+            });
+        });
+    }
+
+    template <typename Function>
+    void for_each(const SequencedPolicy&, Function func) const
+    {
+        for_each(std::move(func));
+    }
+
+    template <typename Function>
+    void for_each(const ParallelPolicy& policy, Function func) const
+    {
+        visit_segments(policy, [&func](Node* first, size_t count) {
+            visit_segment(first, count, [&func](const Type& value) {
+                func(value);
+            });
+        });
+    }
+
+    template <typename UnaryOperation>
+    void transform_inplace(const SequencedPolicy&, UnaryOperation op)
+    {
+        transform_inplace(std::move(op));
+    }
+
+    template <typename UnaryOperation>
+    void transform_inplace(const ParallelPolicy& policy, UnaryOperation op)
+    {
+        [[maybe_unused]] FingerprintRefresh refresh{ *this };
+        visit_segments(policy, [&op](Node* first, size_t count) {
+            visit_segment(first, count, [&op](Type& value) {
+                value = op(std::move(value));
+            });
+        });
+    }
+
+    template <typename T, typename BinaryOperation = std::plus<>>
+    [[nodiscard]] T reduce(const SequencedPolicy&, T init, BinaryOperation op = {}) const
+    {
+        return reduce(std::move(init), std::move(op));
+    }
+
+    template <typename T, typename BinaryOperation = std::plus<>>
+    [[nodiscard]] T reduce(const ParallelPolicy& policy, T init, BinaryOperation op = {}) const
+    {
+        std::mutex result_mutex;
+        visit_segments(policy, [&init, &op, &result_mutex](Node* first, size_t count) {
+            T partial(first->value);
+            visit_segment(first->next_node, count - 1, [&partial, &op](const Type& value) {
+                partial = op(std::move(partial), value);
+            });
+            std::lock_guard lock(result_mutex);
+            init = op(std::move(init), std::move(partial));
+        });
+        return init;
+    }
+
+    template <typename Predicate>
+    [[nodiscard]] size_t count_if(const SequencedPolicy&, Predicate pred) const
+    {
+        return count_if(std::move(pred));
+    }
+
+    template <typename Predicate>
+    [[nodiscard]] size_t count_if(const ParallelPolicy& policy, Predicate pred) const
+    {
+        std::atomic<size_t> total{ 0 };
+        visit_segments(policy, [&total, &pred](Node* first, size_t count) {
+            size_t matches = 0;
+            visit_segment(first, count, [&matches, &pred](const Type& value) {
+                if (pred(value))
+                {
+                    ++matches;
+                }
+            });
+            total.fetch_add(matches, std::memory_order_relaxed);
+        });
+        return total.load(std::memory_order_relaxed);
+    }
+
+    template <typename Predicate>
+    [[nodiscard]] Iterator find_if(Predicate pred, size_t prefetch_distance = default_prefetch_distance)
+    {
+        return Iterator{ visit_nodes(head_.next_node, prefetch_distance, [&pred](const Type& value) {
+            return !pred(value);
+        }) };
+    }
+
+    template <typename Predicate>
+    [[nodiscard]] ConstIterator find_if(Predicate pred, size_t prefetch_distance = default_prefetch_distance) const
+    {
+        return ConstIterator{ visit_nodes(head_.next_node, prefetch_distance, [&pred](const Type& value) {
+            return !pred(value);
+        }) };
+    }
+
+    // Positional access. Without a position index, reaching position k walks k nodes. With
+    // PositionIndex the non-const overloads first rebuild a dropped index if k, or n, spans
+    // at least two checkpoints, and then walk at most about M nodes; the const overloads
+    // never modify the list, so they use the index only if it is built, and walk otherwise.
+    // build_index() builds it up front, for instance before handing the list to readers.
+    [[nodiscard]] CUSTOM_LIST_CONSTEXPR reference at(size_t k)
+    {
+        check_position(k);
+        prepare_index(k);
+        return node_at(k)->value;
+    }
+
+    [[nodiscard]] CUSTOM_LIST_CONSTEXPR const_reference at(size_t k) const
+    {
+        check_position(k);
+        return node_at(k)->value;
+    }
+
+    // Iterator to the element at position k, or end() if k == size().
+    [[nodiscard]] CUSTOM_LIST_CONSTEXPR Iterator iterator_at(size_t k)
+    {
+        assert(k <= size_);
+
+        prepare_index(k);
+        return Iterator{ node_at(k) };
+    }
+
+    [[nodiscard]] CUSTOM_LIST_CONSTEXPR ConstIterator iterator_at(size_t k) const
+    {
+        assert(k <= size_);
+
+        return ConstIterator{ node_at(k) };
+    }
+
+    // Iterator n elements past it; it may be before_begin(), and the result end().
+    [[nodiscard]] CUSTOM_LIST_CONSTEXPR Iterator advance(ConstIterator it, size_t n)
+    {
+        prepare_index(n);
+        return Iterator{ advance_node(it.node_, n) };
+    }
+
+    [[nodiscard]] CUSTOM_LIST_CONSTEXPR ConstIterator advance(ConstIterator it, size_t n) const
+    {
+        return ConstIterator{ advance_node(it.node_, n) };
+    }
+
+    // Cuts the list before position k and returns the elements from k on as a new list with
+    // the same allocator. Only finding the cut is positional; the cut itself relinks one
+    // pointer and keeps the checkpoints before it. Inline nodes past the cut, and a
+    // fingerprint, cost a walk over the elements moved.
+    [[nodiscard]] SingleLinkedList split_at(size_t k)
+    {
+        assert(k <= size_);
+
+        SingleLinkedList rest(node_alloc_);
+        Node* before = &head_;
+        if (k > 0)
+        {
+            prepare_index(k - 1);
+            before = node_at(k - 1);
+        }
+        if (before->next_node == nullptr)
+        {
+            return rest;
+        }
+
+        bool index_valid = false;
+        if constexpr (kIndexSpacing > 0)
+        {
+            index_valid = index_.valid;
+        }
+        rest.adopt_inline_nodes(*this, before, nullptr);
+        Node* last = nullptr;
+        uint64_t inner_links = 0;
+        if constexpr (kFingerprint)
+        {
+            last = last_node();
+            inner_links = fingerprint_unlinking(before, last);
+        }
+
+        rest.head_.next_node = std::exchange(before->next_node, nullptr);
+        rest.size_ = size_ - k;
+        size_ = k;
+        if constexpr (kTracksTail)
+        {
+            rest.tail_ = tail_;
+        }
+        relinked(before);
+        if (index_valid)
+        {
+            keep_index_prefix();
+        }
+        rest.record_size();
+        rest.fingerprint_linked(&rest.head_, last, inner_links);
+        return rest;
+    }
+
+    // Builds the position index now if it is not built. Takes O(n) time.
+    void build_index()
+    {
+        static_assert(kIndexSpacing > 0, "build_index requires PositionIndex");
+
+        if (index_.valid)
+        {
+            return;
+        }
+        index_.nodes.clear();
+        index_.positions.clear();
+        const size_t count = (size_ + kIndexSpacing - 1) / kIndexSpacing;
+        index_.nodes.reserve(count);
+        index_.positions.reserve(count);
+        size_t position = 0;
+        for (Node* node = head_.next_node; node != nullptr; node = node->next_node, ++position)
+        {
+            if (position % kIndexSpacing == 0)
+            {
+                index_.nodes.push_back(node);
+                index_.positions.emplace(node, position);
+            }
+        }
+        index_.valid = true;
+    }
+
+    // Reallocates every node, assigning the new nodes to list positions in ascending address
+    // order, so that successors sit next to each other as far as the allocator permits.
+    // Values are moved if their move constructor is noexcept and copied otherwise. Provides
+    // the strong exception guarantee. Needs memory for a second copy of the nodes while it runs.
+    void defragment()
+    {
+        if (size_ == 0)
+        {
+            return;
+        }
+
+        std::vector<Node*> fresh;
+        fresh.reserve(size_);
+        try
+        {
+            while (fresh.size() < size_)
+            {
+                fresh.push_back(allocate_node());
+            }
+        }
+        catch (...)
+        {
+            for (Node* node : fresh)
+            {
+                deallocate_node(node);
+            }
+            throw;
+        }
+        std::sort(fresh.begin(), fresh.end(), std::less<Node*>{});
+
+        size_t constructed = 0;
+        try
+        {
+            for (Node* node = head_.next_node; node != nullptr; node = node->next_node, ++constructed)
+            {
+                NodeAllocTraits::construct(node_alloc_, fresh[constructed], nullptr, std::move_if_noexcept(node->value));
+                record_construction<decltype(std::move_if_noexcept(node->value))>();
+            }
+        }
+        catch (...)
+        {
+            for (size_t i = 0; i < fresh.size(); ++i)
+            {
+                if (i < constructed)
+                {
+                    NodeAllocTraits::destroy(node_alloc_, fresh[i]);
+                }
+                deallocate_node(fresh[i]);
+            }
+            throw;
+        }
+
+        for (size_t i = 1; i < fresh.size(); ++i)
+        {
+            fresh[i - 1]->next_node = fresh[i];
+        }
+
+        Node* old = std::exchange(head_.next_node, fresh.front());
+        relinked(fresh.back());
+        while (old != nullptr)
+        {
+            destroy_node(std::exchange(old, old->next_node));
+        }
+    }
+
+    // Estimates how scattered the nodes are: the fraction, from 0 to 1, of links whose
+    // successor does not directly follow its predecessor in memory (allowing for allocator
+    // headers). Only the first max_links links are inspected, so callers can bound the cost.
+    [[nodiscard]] double fragmentation(size_t max_links = std::numeric_limits<size_t>::max()) const noexcept
+    {
+        constexpr uintptr_t kAllocatorSlack = 64;
+
+        size_t links = 0;
+        size_t scattered = 0;
+        for (const Node* node = head_.next_node; node != nullptr && node->next_node != nullptr && links < max_links; node = node->next_node)
+        {
+            const uintptr_t from = reinterpret_cast<uintptr_t>(node);
+            const uintptr_t to = reinterpret_cast<uintptr_t>(node->next_node);
+            if (to <= from || to - from > sizeof(Node) + kAllocatorSlack)
+            {
+                ++scattered;
+            }
+            ++links;
+        }
+        return links == 0 ? 0.0 : static_cast<double>(scattered) / static_cast<double>(links);
+    }
+
+    // Writes the list in the format described in list_serialization.h, with values encoded
+    // by ListSerializer<Type>. Raw values are copied into the chunk buffer as they are.
+    void serialize(std::ostream& out, size_t chunk_bytes = list_format::kDefaultChunkBytes) const
+    {
+        ListWriter writer = ListWriter::begin<Type>(out, size_, chunk_bytes);
+        for (const Type& value : *this)
+        {
+            writer.write_value(value);
+        }
+        writer.finish();
+    }
+
+    // Replaces the contents with a list read from in, building it front to back in one pass.
+    // Throws ListFormatError if the data is malformed, damaged or was written
+    // for an incompatible Type; on any exception the list is left unchanged.
+    void deserialize(std::istream& in)
+    {
+        ListReader reader = ListReader::begin<Type>(in);
+        SingleLinkedList tmp(node_alloc_);
+        tmp.link_chain(&tmp.head_, tmp.make_chain(reader.count(), [&reader]() {
+            return reader.read_value<Type>();
+        }));
+        reader.finish();
+        commit(tmp);
+    }
+
+    // Bytes held by the list: the object itself, inline node storage included, plus its
+    // allocated nodes, not counting any bookkeeping the allocator adds per allocation.
+    [[nodiscard]] size_t memory_footprint() const noexcept
+    {
+        return sizeof(SingleLinkedList) + (size_ - inline_used()) * sizeof(Node);
+    }
+
+    // Statistics of lists with ListStats. stats() covers the operations of this list object;
+    // type_stats() covers every list with ListStats holding Type, whatever its allocator.
+    [[nodiscard]] const ListStatistics& stats() const noexcept
+    {
+        static_assert(kStats, "stats require ListStats");
+
+        return stats_;
+    }
+
+    [[nodiscard]] static ListStatistics type_stats() noexcept
+    {
+        static_assert(kStats, "type_stats require ListStats");
+
+        return TypeListStatistics<Type>().snapshot();
+    }
+
+    void dump_stats(std::ostream& out) const
+    {
+        static_assert(kStats, "dump_stats requires ListStats");
+
+        out << "memory_footprint: " << memory_footprint() << "\n";
+        stats_.print(out, sizeof(Node), size_);
+    }
+
+    static void dump_type_stats(std::ostream& out)
+    {
+        static_assert(kStats, "dump_type_stats requires ListStats");
+
+        const SharedListStatistics& totals = TypeListStatistics<Type>();
+        totals.snapshot().print(out, sizeof(Node), totals.live_nodes());
+    }
+
+    // Order-sensitive hash of the contents: equal lists hash equal. Takes constant time with
+    // Fingerprint and walks the list otherwise; both compute the same value.
+    [[nodiscard]] size_t hash() const noexcept
+    {
+        if constexpr (kFingerprint)
+        {
+            return list_fingerprint::Finish(fingerprint_, size_);
+        }
+        else
+        {
+            return list_fingerprint::Finish(link_sum(&head_, nullptr), size_);
+        }
+    }
+
+    // The fingerprint follows every change the list makes, but not values modified through
+    // iterators or references; call this after doing so, or hash() and operator== go wrong.
+    // for_each and transform_inplace call it themselves.
+    CUSTOM_LIST_CONSTEXPR void refresh_fingerprint() noexcept
+    {
+        if constexpr (kFingerprint)
+        {
+            fingerprint_ = link_sum(&head_, nullptr);
+        }
+    }
+
+private:
+
+    static constexpr size_t kRemovalBatch = 64;
+
+    // Nodes linked from first to last, not yet part of any list.
+    struct Chain
+    {
+        Node* first = nullptr;
+        Node* last = nullptr;
+        size_t size = 0;
+
+        CUSTOM_LIST_CONSTEXPR void push_back(Node* node) noexcept
+        {
+            if (first == nullptr)
+            {
+                first = node;
+            }
+            else
+            {
+                last->next_node = node;
+            }
+            last = node;
+            ++size;
+        }
+    };
+
+    Node head_;
+    size_t size_ = 0;
+    CUSTOM_LIST_NO_UNIQUE_ADDRESS NodeAllocator node_alloc_;
+    // Last node, or nullptr when the list is empty, so that moving head_ never invalidates it.
+    CUSTOM_LIST_NO_UNIQUE_ADDRESS TailStorage tail_{};
+    CUSTOM_LIST_NO_UNIQUE_ADDRESS StatsStorage stats_{};
+    CUSTOM_LIST_NO_UNIQUE_ADDRESS InlineStorage inline_;
+    CUSTOM_LIST_NO_UNIQUE_ADDRESS FingerprintStorage fingerprint_ = empty_fingerprint();
+    CUSTOM_LIST_NO_UNIQUE_ADDRESS IndexStorage index_;
+
+    // Returns a free inline slot if there is one and allocates otherwise. Only allocator
+    // calls count as allocations in the statistics.
+    CUSTOM_LIST_CONSTEXPR Node* allocate_node()
+    {
+        if (Node* slot = take_inline_slot())
+        {
+            return slot;
+        }
+        return allocate_heap_node();
+    }
+
+    CUSTOM_LIST_CONSTEXPR void deallocate_node(Node* node) noexcept
+    {
+        if (owns_inline(node))
+        {
+            release_inline_slot(node);
+            return;
+        }
+        NodeAllocTraits::deallocate(node_alloc_, node, 1);
+        record_stats([](auto& stats) {
+            stats.record_deallocation();
+        });
+    }
+
+    CUSTOM_LIST_CONSTEXPR Node* allocate_heap_node()
+    {
+        Node* node = NodeAllocTraits::allocate(node_alloc_, 1);
+        record_stats([](auto& stats) {
+            stats.record_allocation();
+        });
+        return node;
+    }
+
+    [[nodiscard]] CUSTOM_LIST_CONSTEXPR bool owns_inline([[maybe_unused]] const Node* node) const noexcept
+    {
+        if constexpr (kInlineCapacity > 0)
+        {
+            const auto address = reinterpret_cast<uintptr_t>(node);
+            const auto storage = reinterpret_cast<uintptr_t>(inline_.storage);
+            return address >= storage && address < storage + sizeof(inline_.storage);
+        }
+        else
+        {
+            return false;
+        }
+    }
+
+    [[nodiscard]] CUSTOM_LIST_CONSTEXPR size_t inline_used() const noexcept
+    {
+        if constexpr (kInlineCapacity > 0)
+        {
+            return inline_.used;
+        }
+        else
+        {
+            return 0;
+        }
+    }
+
+    // Uninitialized storage for one node from the inline slots, or nullptr if all are taken.
+    CUSTOM_LIST_CONSTEXPR Node* take_inline_slot() noexcept
+    {
+        if constexpr (kInlineCapacity > 0)
+        {
+            if (inline_.free_mask == 0)
+            {
+                return nullptr;
+            }
+            size_t index = 0;
+            while ((inline_.free_mask >> index & 1) == 0)
+            {
+                ++index;
+            }
+            inline_.free_mask &= ~(uint64_t{ 1 } << index);
+            ++inline_.used;
+            return reinterpret_cast<Node*>(inline_.storage + index * sizeof(Node));
+        }
+        else
+        {
+            return nullptr;
+        }
+    }
+
+    CUSTOM_LIST_CONSTEXPR void release_inline_slot([[maybe_unused]] Node* node) noexcept
+    {
+        if constexpr (kInlineCapacity > 0)
+        {
+            const size_t index = (reinterpret_cast<unsigned char*>(node) - inline_.storage) / sizeof(Node);
+            inline_.free_mask |= uint64_t{ 1 } << index;
+            --inline_.used;
+        }
+    }
+
+    // Before nodes of from are linked into this list, moves the value of every node in the
+    // chain after before, up to and including last or to the end if last is null, that lives
+    // in from's inline storage into a node owned by this list, and unlinks and frees the old
+    // node. Returns last, or its replacement. Allocates the nodes that this list's free inline
+    // slots cannot provide up front, so it either throws without changing anything or succeeds.
+    CUSTOM_LIST_CONSTEXPR Node* adopt_inline_nodes([[maybe_unused]] SingleLinkedList& from, [[maybe_unused]] Node* before, Node* last)
+    {
+        if constexpr (kInlineCapacity > 0)
+        {
+            assert(this != &from);
+
+            const Node* const end = last != nullptr ? last->next_node : nullptr;
+            size_t count = 0;
+            for (const Node* node = before->next_node; node != end && count < from.inline_.used; node = node->next_node)
+            {
+                count += from.owns_inline(node) ? 1 : 0;
+            }
+            if (count == 0)
+            {
+                return last;
+            }
+
+            std::array<Node*, kInlineCapacity> heap_nodes{};
+            const size_t free_slots = kInlineCapacity - inline_.used;
+            const size_t heap_count = count > free_slots ? count - free_slots : 0;
+            size_t allocated = 0;
+            try
+            {
+                for (; allocated < heap_count; ++allocated)
+                {
+                    heap_nodes[allocated] = allocate_heap_node();
+                }
+            }
+            catch (...)
+            {
+                while (allocated > 0)
+                {
+                    deallocate_node(heap_nodes[--allocated]);
+                }
+                throw;
+            }
+
+            for (Node* prev = before; count > 0; prev = prev->next_node)
+            {
+                Node* node = prev->next_node;
+                if (!from.owns_inline(node))
+                {
+                    continue;
+                }
+                Node* fresh = take_inline_slot();
+                if (fresh == nullptr)
+                {
+                    fresh = heap_nodes[--allocated];
+                }
+                NodeAllocTraits::construct(node_alloc_, fresh, node->next_node, std::move(node->value));
+                record_construction<Type&&>();
+                prev->next_node = fresh;
+                if constexpr (kTracksTail)
+                {
+                    from.tail_ = from.tail_ == node ? fresh : from.tail_;
+                    tail_ = tail_ == node ? fresh : tail_;
+                }
+                last = last == node ? fresh : last;
+                NodeAllocTraits::destroy(from.node_alloc_, node);
+                from.release_inline_slot(node);
+                --count;
+            }
+            from.drop_index();
+        }
+        return last;
+    }
+
+    template <typename... Args>
+    CUSTOM_LIST_CONSTEXPR Node* create_node(Node* next, Args&&... args)
+    {
+        Node* node = allocate_node();
+        try
+        {
+            NodeAllocTraits::construct(node_alloc_, node, next, std::forward<Args>(args)...);
+        }
+        catch (...)
+        {
+            deallocate_node(node);
+            throw;
+        }
+        record_construction<Args...>();
+        return node;
+    }
+
+    CUSTOM_LIST_CONSTEXPR void destroy_node(Node* node) noexcept
+    {
+        NodeAllocTraits::destroy(node_alloc_, node);
+        deallocate_node(node);
+    }
+
+    // Destroys and frees up to count nodes from the front of chain, advancing it; returns
+    // true while nodes remain.
+    static bool free_chain(NodeAllocator& alloc, Node*& chain, size_t count) noexcept
+    {
+        for (; chain != nullptr && count > 0; --count)
+        {
+            Node* next = chain->next_node;
+            NodeAllocTraits::destroy(alloc, chain);
+            NodeAllocTraits::deallocate(alloc, chain, 1);
+            chain = next;
+        }
+        return chain != nullptr;
+    }
+
+    // Statistics hooks. Each compiles to nothing without ListStats; with it, events go to
+    // this list's counters and to the totals for Type.
+    template <typename Record>
+    CUSTOM_LIST_CONSTEXPR void record_stats([[maybe_unused]] Record record) noexcept
+    {
+        if constexpr (kStats)
+        {
+            record(stats_);
+            record(TypeListStatistics<Type>());
+        }
+    }
+
+    // Counts a node value constructed from Args as a copy or a move of Type, if it was either.
+    template <typename... Args>
+    CUSTOM_LIST_CONSTEXPR void record_construction() noexcept
+    {
+        if constexpr (kStats && sizeof...(Args) == 1)
+        {
+            using Arg = std::tuple_element_t<0, std::tuple<Args...>>;
+            if constexpr (std::is_same_v<std::decay_t<Arg>, Type>)
+            {
+                if constexpr (std::is_rvalue_reference_v<Arg&&> && !std::is_const_v<std::remove_reference_t<Arg>>)
+                {
+                    record_stats([](auto& stats) {
+                        stats.record_move();
+                    });
+                }
+                else
+                {
+                    record_stats([](auto& stats) {
+                        stats.record_copy();
+                    });
+                }
+            }
+        }
+    }
+
+    CUSTOM_LIST_CONSTEXPR void record_size() noexcept
+    {
+        if constexpr (kStats)
+        {
+            stats_.record_size(size_);
+        }
+    }
+
+    CUSTOM_LIST_CONSTEXPR void record_insert([[maybe_unused]] const Node* pos) noexcept
+    {
+        if constexpr (kStats)
+        {
+            const size_t distance = distance_from_front(pos);
+            record_stats([distance](auto& stats) {
+                stats.record_insert(distance);
+            });
+        }
+    }
+
+    CUSTOM_LIST_CONSTEXPR void record_erase([[maybe_unused]] const Node* pos) noexcept
+    {
+        if constexpr (kStats)
+        {
+            const size_t distance = distance_from_front(pos);
+            record_stats([distance](auto& stats) {
+                stats.record_erase(distance);
+            });
+        }
+    }
+
+    // Number of links from head_ to pos, walking at most ListStatistics::kMaxMeasuredDistance
+    // of them; returns that bound if pos lies further out.
+    [[nodiscard]] CUSTOM_LIST_CONSTEXPR size_t distance_from_front(const Node* pos) const noexcept
+    {
+        size_t distance = 0;
+        for (const Node* node = &head_; node != pos && node != nullptr && distance < ListStatistics::kMaxMeasuredDistance; node = node->next_node)
+        {
+            ++distance;
+        }
+        return distance;
+    }
+
+    // Fingerprint hooks, compiled to nothing without Fingerprint. A chain is moved by calling
+    // fingerprint_unlinking before it is cut out, which returns the sum of its inner links,
+    // and fingerprint_linked with that sum once it is linked in again.
+    [[nodiscard]] static constexpr FingerprintStorage empty_fingerprint() noexcept
+    {
+        if constexpr (kFingerprint)
+        {
+            return list_fingerprint::kEmpty;
+        }
+        else
+        {
+            return FingerprintStorage{};
+        }
+    }
+
+    [[nodiscard]] CUSTOM_LIST_CONSTEXPR uint64_t fingerprint_key(const Node* node) const noexcept
+    {
+        if (node == &head_)
+        {
+            return list_fingerprint::kBeginKey;
+        }
+        return node == nullptr ? list_fingerprint::kEndKey : list_fingerprint::ValueKey(node->value);
+    }
+
+    // Sum of the hashes of the links leaving from and the nodes after it, up to but excluding to.
+    [[nodiscard]] CUSTOM_LIST_CONSTEXPR uint64_t link_sum(const Node* from, const Node* to) const noexcept
+    {
+        uint64_t sum = 0;
+        uint64_t key = fingerprint_key(from);
+        for (const Node* node = from; node != to; node = node->next_node)
+        {
+            const uint64_t next_key = fingerprint_key(node->next_node);
+            sum += list_fingerprint::LinkHash(key, next_key);
+            key = next_key;
+        }
+        return sum;
+    }
+
+    // Called before the chain from prev's successor to last is unlinked from this list.
+    CUSTOM_LIST_CONSTEXPR uint64_t fingerprint_unlinking([[maybe_unused]] const Node* prev, [[maybe_unused]] const Node* last) noexcept
+    {
+        if constexpr (kFingerprint)
+        {
+            const uint64_t inner_links = link_sum(prev->next_node, last);
+            const uint64_t prev_key = fingerprint_key(prev);
+            const uint64_t next_key = fingerprint_key(last->next_node);
+            fingerprint_ += list_fingerprint::LinkHash(prev_key, next_key) - list_fingerprint::LinkHash(prev_key, fingerprint_key(prev->next_node)) -
+                inner_links - list_fingerprint::LinkHash(fingerprint_key(last), next_key);
+            return inner_links;
+        }
+        else
+        {
+            return 0;
+        }
+    }
+
+    // Called after the chain from prev's successor to last, with inner links summing to
+    // inner_links, was linked into this list.
+    CUSTOM_LIST_CONSTEXPR void fingerprint_linked([[maybe_unused]] const Node* prev, [[maybe_unused]] const Node* last, [[maybe_unused]] uint64_t inner_links) noexcept
+    {
+        if constexpr (kFingerprint)
+        {
+            const uint64_t prev_key = fingerprint_key(prev);
+            const uint64_t next_key = fingerprint_key(last->next_node);
+            fingerprint_ += list_fingerprint::LinkHash(prev_key, fingerprint_key(prev->next_node)) + inner_links +
+                list_fingerprint::LinkHash(fingerprint_key(last), next_key) - list_fingerprint::LinkHash(prev_key, next_key);
+        }
+    }
+
+    // Refreshes the fingerprint on leaving a scope that handed out values for modification,
+    // also when it is left by an exception.
+    struct FingerprintRefresh
+    {
+        SingleLinkedList& list;
+
+        CUSTOM_LIST_CONSTEXPR ~FingerprintRefresh()
+        {
+            list.refresh_fingerprint();
+        }
+    };
+
+    // Exchanges contents and allocators regardless of propagate_on_container_swap.
+    CUSTOM_LIST_CONSTEXPR void swap_all(SingleLinkedList& other) noexcept
+    {
+        std::swap(other.node_alloc_, node_alloc_);
+        swap_contents(other);
+    }
+
+    // Inline nodes stay in the object they belong to, so with inline storage the contents
+    // take a detour through a third list, each step moving only inline values into free slots.
+    CUSTOM_LIST_CONSTEXPR void swap_contents(SingleLinkedList& other) noexcept
+    {
+        if constexpr (kInlineCapacity > 0)
+        {
+            SingleLinkedList detour(node_alloc_);
+            detour.steal_nodes(*this);
+            steal_nodes(other);
+            other.steal_nodes(detour);
+        }
+        else
+        {
+            std::swap(other.head_.next_node, head_.next_node);
+            std::swap(other.size_, size_);
+            std::swap(other.tail_, tail_);
+            std::swap(other.fingerprint_, fingerprint_);
+            drop_index();
+            other.drop_index();
+        }
+    }
+
+    // Takes over the contents of tmp, a temporary built with the allocator this list should
+    // end up with. The old contents are freed by tmp; with ListStats the work tmp did,
+    // including that, is added to this list's counters.
+    CUSTOM_LIST_CONSTEXPR void commit(SingleLinkedList& tmp) noexcept
+    {
+        swap_all(tmp);
+        if constexpr (kStats)
+        {
+            tmp.clear();
+            stats_.merge(tmp.stats_);
+        }
+    }
+
+    CUSTOM_LIST_CONSTEXPR void steal_nodes(SingleLinkedList& other) noexcept
+    {
+        assert(head_.next_node == nullptr);
+
+        head_.next_node = std::exchange(other.head_.next_node, nullptr);
+        size_ = std::exchange(other.size_, 0);
+        tail_ = std::exchange(other.tail_, TailStorage{});
+        fingerprint_ = std::exchange(other.fingerprint_, empty_fingerprint());
+        drop_index();
+        other.drop_index();
+        // This list has no nodes, so its free inline slots take all of other's inline nodes.
+        adopt_inline_nodes(other, &head_, nullptr);
+    }
+
+    // Records node as the last node if nothing follows it, and drops the position index.
+    // Called with the node before or after every position whose successor changed, which
+    // keeps tail_ exact.
+    CUSTOM_LIST_CONSTEXPR void relinked([[maybe_unused]] Node* node) noexcept
+    {
+        if constexpr (kTracksTail)
+        {
+            if (node->next_node == nullptr)
+            {
+                tail_ = node == &head_ ? nullptr : node;
+            }
+        }
+        drop_index();
+    }
+
+    // Position index hooks, compiled to nothing without PositionIndex.
+    CUSTOM_LIST_CONSTEXPR void drop_index() noexcept
+    {
+        if constexpr (kIndexSpacing > 0)
+        {
+            index_.valid = false;
+        }
+    }
+
+    // Rebuilds a dropped index before a walk of distance nodes, if that spans two checkpoints.
+    CUSTOM_LIST_CONSTEXPR void prepare_index([[maybe_unused]] size_t distance)
+    {
+        if constexpr (kIndexSpacing > 0)
+        {
+            if (!index_.valid && distance >= 2 * kIndexSpacing)
+            {
+                build_index();
+            }
+        }
+    }
+
+    // After the list was cut short, restores the index with the checkpoints that remain.
+    void keep_index_prefix() noexcept
+    {
+        if constexpr (kIndexSpacing > 0)
+        {
+            const size_t kept = (size_ + kIndexSpacing - 1) / kIndexSpacing;
+            for (size_t i = kept; i < index_.nodes.size(); ++i)
+            {
+                index_.positions.erase(index_.nodes[i]);
+            }
+            index_.nodes.erase(index_.nodes.begin() + static_cast<std::ptrdiff_t>(kept), index_.nodes.end());
+            index_.valid = true;
+        }
+    }
+
+    CUSTOM_LIST_CONSTEXPR void check_position(size_t k) const
+    {
+        if (k >= size_)
+        {
+            throw std::out_of_range("SingleLinkedList::at: position out of range");
+        }
+    }
+
+    // The node at position k, or nullptr if k == size_, starting from the checkpoint
+    // before k if the index is built.
+    [[nodiscard]] CUSTOM_LIST_CONSTEXPR Node* node_at(size_t k) const noexcept
+    {
+        assert(k <= size_);
+
+        if (k == size_)
+        {
+            return nullptr;
+        }
+        Node* node = head_.next_node;
+        if constexpr (kIndexSpacing > 0)
+        {
+            if (index_.valid)
+            {
+                node = index_.nodes[k / kIndexSpacing];
+                k %= kIndexSpacing;
+            }
+        }
+        for (; k > 0; --k)
+        {
+            node = node->next_node;
+        }
+        return node;
+    }
+
+    // The node n links after node. With the index built, a checkpoint turns up within
+    // kIndexSpacing links, and the rest of the way is taken from there.
+    [[nodiscard]] CUSTOM_LIST_CONSTEXPR Node* advance_node(Node* node, size_t n) const noexcept
+    {
+        if constexpr (kIndexSpacing > 0)
+        {
+            for (; index_.valid && n > kIndexSpacing; --n)
+            {
+                const auto checkpoint = index_.positions.find(node);
+                if (checkpoint != index_.positions.end())
+                {
+                    return node_at(checkpoint->second + n);
+                }
+                node = node->next_node;
+            }
+        }
+        for (; n > 0; --n)
+        {
+            assert(node != nullptr);
+
+            node = node->next_node;
+        }
+        return node;
+    }
+
+    // The last node, or head_ if the list is empty. Without tail tracking this walks the list.
+    [[nodiscard]] CUSTOM_LIST_CONSTEXPR Node* last_node() const noexcept
+    {
+        if constexpr (kTracksTail)
+        {
+            if (tail_ != nullptr)
+            {
+                return tail_;
+            }
+        }
+        Node* node = const_cast<Node*>(&head_);
+        if constexpr (!kTracksTail)
+        {
+            while (node->next_node != nullptr)
+            {
+                node = node->next_node;
+            }
+        }
+        return node;
+    }
+
+    static void prefetch_node(const Node* node) noexcept
+    {
+        // Large values span several cache lines; fetch up to four of them.
+        constexpr size_t kCacheLine = 64;
+        constexpr size_t kPrefetchBytes = std::min<size_t>(sizeof(Node), kCacheLine * 4);
+
+        const char* bytes = reinterpret_cast<const char*>(node);
+        for (size_t offset = 0; offset < kPrefetchBytes; offset += kCacheLine)
+        {
+            CUSTOM_LIST_PREFETCH(bytes + offset);
+        }
+    }
+
+    // Calls visit on each value from node on until it returns false, and returns the node
+    // it stopped at, or nullptr if the whole chain was visited.
+    template <typename Visitor>
+    static Node* visit_nodes(Node* node, size_t prefetch_distance, Visitor&& visit)
+    {
+        Node* ahead = node;
+        for (size_t i = 0; i < prefetch_distance && ahead != nullptr; ++i)
+        {
+            prefetch_node(ahead);
+            ahead = ahead->next_node;
+        }
+
+        for (; node != nullptr; node = node->next_node)
+        {
+            if (ahead != nullptr)
+            {
+                prefetch_node(ahead);
+                ahead = ahead->next_node;
+            }
+            if (!visit(node->value))
+            {
+                return node;
+            }
+        }
+        return nullptr;
+    }
+
+    // Calls visit on the count values starting at node, prefetching ahead like visit_nodes.
+    template <typename Visitor>
+    static void visit_segment(Node* node, size_t count, Visitor&& visit)
+    {
+        if (count == 0)
+        {
+            return;
+        }
+        visit_nodes(node, default_prefetch_distance, [&visit, &count](auto& value) {
+            visit(value);
+            return --count > 0;
+        });
+    }
+
+    // Splits the list into segments as described for the parallel algorithms and calls
+    // process(first_node, count) for each, as a task on the policy's pool. Short lists, or a
+    // pool with a single thread, take one segment processed on the calling thread.
+    template <typename Process>
+    void visit_segments(const ParallelPolicy& policy, Process&& process) const
+    {
+        if (size_ == 0)
+        {
+            return;
+        }
+
+        WorkStealingThreadPool& pool = policy.pool != nullptr ? *policy.pool : WorkStealingThreadPool::shared();
+        size_t segments = policy.segments != 0 ? policy.segments : pool.concurrency() * 4;
+        segments = std::min(segments, std::max<size_t>(size_ / std::max<size_t>(policy.min_segment_size, 1), 1));
+
+        Node* node = head_.next_node;
+        if (segments == 1 || pool.concurrency() == 1)
+        {
+            process(node, size_);
+            return;
+        }
+
+        const size_t segment_size = (size_ + segments - 1) / segments;
+        TaskGroup group(pool);
+        for (size_t done = 0; done < size_;)
+        {
+            const size_t count = std::min(segment_size, size_ - done);
+            group.run([&process, node, count]() {
+                process(node, count);
+            });
+            done += count;
+            for (size_t i = 0; i < count && done < size_; ++i)
+            {
+                node = node->next_node;
+            }
+        }
+        group.wait();
+    }
+
+    // Detaches the chain following the first count nodes of chain and returns it.
+    static CUSTOM_LIST_CONSTEXPR Node* cut_after(Node* chain, size_t count) noexcept
+    {
+        if (chain == nullptr)
+        {
+            return nullptr;
+        }
+        while (--count > 0 && chain->next_node != nullptr)
+        {
+            chain = chain->next_node;
+        }
+        return std::exchange(chain->next_node, nullptr);
+    }
+
+    // Takes over the size of other, whose nodes merge() has linked into this list up to last.
+    CUSTOM_LIST_CONSTEXPR void finish_merge(SingleLinkedList& other, Node* last) noexcept
+    {
+        relinked(last);
+        size_ += std::exchange(other.size_, 0);
+        record_size();
+        other.relinked(&other.head_);
+        other.fingerprint_ = empty_fingerprint();
+        refresh_fingerprint();
+    }
+
+    // The last node of the chain starting at node.
+    static CUSTOM_LIST_CONSTEXPR Node* chain_end(Node* node) noexcept
+    {
+        while (node->next_node != nullptr)
+        {
+            node = node->next_node;
+        }
+        return node;
+    }
+
+    // Links the stable merge of the sorted chains left and right after tail and returns the last node.
+    // If comp throws, the unmerged rest of left and then that of right are linked after the
+    // merged part, so that no node is lost, and the exception propagates.
+    template <typename Compare>
+    static CUSTOM_LIST_CONSTEXPR Node* merge_chains(Node* tail, Node* left, Node* right, Compare& comp)
+    {
+        try
+        {
+            while (left != nullptr && right != nullptr)
+            {
+                if (comp(right->value, left->value))
+                {
+                    tail->next_node = right;
+                    right = right->next_node;
+                }
+                else
+                {
+                    tail->next_node = left;
+                    left = left->next_node;
+                }
+                tail = tail->next_node;
+            }
+        }
+        catch (...)
+        {
+            tail->next_node = left;
+            chain_end(tail)->next_node = right;
+            throw;
+        }
+
+        tail->next_node = left != nullptr ? left : right;
+        while (tail->next_node != nullptr)
+        {
+            tail = tail->next_node;
+        }
+        return tail;
+    }
+
+    // Builds a detached chain of count nodes owned by this list, with values constructed
+    // from make_value() in order. If anything throws, every node built so far is freed and
+    // the exception propagates.
+    template <typename MakeValue>
+    CUSTOM_LIST_CONSTEXPR Chain make_chain(size_t count, MakeValue&& make_value)
+    {
+        Chain chain;
+        try
+        {
+            while (chain.size < count)
+            {
+                chain.push_back(create_node(nullptr, make_value()));
+            }
+        }
+        catch (...)
+        {
+            destroy_chain(chain.first);
+            throw;
+        }
+        return chain;
+    }
+
+    template <typename InputIterator, typename Sentinel>
+    CUSTOM_LIST_CONSTEXPR Chain make_chain(InputIterator first, Sentinel last)
+    {
+        Chain chain;
+        try
+        {
+            for (; first != last; ++first)
+            {
+                chain.push_back(create_node(nullptr, *first));
+            }
+        }
+        catch (...)
+        {
+            destroy_chain(chain.first);
+            throw;
+        }
+        return chain;
+    }
+
+    // Links chain after pos with a single write to pos and returns the last node linked,
+    // or pos if chain is empty.
+    CUSTOM_LIST_CONSTEXPR Node* link_chain(Node* pos, const Chain& chain) noexcept
+    {
+        if (chain.size == 0)
+        {
+            return pos;
+        }
+
+        uint64_t inner_links = 0;
+        if constexpr (kFingerprint)
+        {
+            inner_links = link_sum(chain.first, chain.last);
+        }
+        chain.last->next_node = pos->next_node;
+        pos->next_node = chain.first;
+        size_ += chain.size;
+        record_size();
+        relinked(chain.last);
+        fingerprint_linked(pos, chain.last, inner_links);
+        return chain.last;
+    }
+
+    // Nodes unlinked by a bulk removal, freed whenever kRemovalBatch have gathered. The rest
+    // are freed, the fingerprint is refreshed and the position index dropped when it goes out
+    // of scope, which also happens if a predicate throws. The node holding *keep_alive is
+    // only freed then.
+    class RemovalBatch
+    {
+    public:
+        explicit RemovalBatch(SingleLinkedList& list, const Type* keep_alive = nullptr) noexcept
+            : list_(list), keep_alive_(keep_alive)
+        {
+        }
+
+        RemovalBatch(const RemovalBatch&) = delete;
+        RemovalBatch& operator=(const RemovalBatch&) = delete;
+
+        ~RemovalBatch()
+        {
+            flush();
+            if (deferred_ != nullptr)
+            {
+                list_.destroy_node(deferred_);
+            }
+            if (count_ > 0)
+            {
+                list_.refresh_fingerprint();
+                list_.drop_index();
+            }
+        }
+
+        void unlink_after(Node* prev) noexcept
+        {
+            Node* node = prev->next_node;
+            prev->next_node = node->next_node;
+            --list_.size_;
+            ++count_;
+            if (&node->value == keep_alive_)
+            {
+                deferred_ = node;
+                return;
+            }
+            pending_[pending_count_++] = node;
+            if (pending_count_ == kRemovalBatch)
+            {
+                flush();
+            }
+        }
+
+        [[nodiscard]] size_t count() const noexcept
+        {
+            return count_;
+        }
+
+    private:
+        SingleLinkedList& list_;
+        const Type* keep_alive_;
+        Node* deferred_ = nullptr;
+        std::array<Node*, kRemovalBatch> pending_;
+        size_t pending_count_ = 0;
+        size_t count_ = 0;
+
+        void flush() noexcept
+        {
+            for (size_t i = 0; i < pending_count_; ++i)
+            {
+                list_.destroy_node(pending_[i]);
+            }
+            pending_count_ = 0;
+        }
+    };
+
+    template <typename Predicate>
+    void remove_nodes(RemovalBatch& removed, Predicate&& pred)
+    {
+        Node* prev = &head_;
+        while (prev->next_node != nullptr)
+        {
+            if (pred(prev->next_node->value))
+            {
+                removed.unlink_after(prev);
+            }
+            else
+            {
+                prev = prev->next_node;
+            }
+        }
+        relinked(prev);
+    }
+
+    CUSTOM_LIST_CONSTEXPR void destroy_chain(Node* node) noexcept
+    {
+        while (node != nullptr)
+        {
+            destroy_node(std::exchange(node, node->next_node));
+        }
+    }
+
+    // Destroys every node after prev, leaving the fingerprint for the caller to refresh.
+    CUSTOM_LIST_CONSTEXPR void truncate_after(Node* prev) noexcept
+    {
+        for (Node* node = std::exchange(prev->next_node, nullptr); node != nullptr; --size_)
+        {
+            destroy_node(std::exchange(node, node->next_node));
+        }
+        relinked(prev);
+    }
+
+    // Replaces the contents with copies of [first, last), all or nothing.
+    template <typename InputIterator, typename Sentinel>
+    CUSTOM_LIST_CONSTEXPR void rebuild(InputIterator first, Sentinel last)
+    {
+        SingleLinkedList tmp(node_alloc_);
+        tmp.link_chain(&tmp.head_, tmp.make_chain(first, last));
+        commit(tmp);
+    }
+};
+
+template <typename Type, typename Allocator, typename TailPolicy, typename StatsPolicy, typename InlinePolicy, typename FingerprintPolicy, typename IndexPolicy>
+CUSTOM_LIST_CONSTEXPR void swap(SingleLinkedList<Type, Allocator, TailPolicy, StatsPolicy, InlinePolicy, FingerprintPolicy, IndexPolicy>& lhs, SingleLinkedList<Type, Allocator, TailPolicy, StatsPolicy, InlinePolicy, FingerprintPolicy, IndexPolicy>& rhs) noexcept
+{
+    lhs.swap(rhs);
+}
+
+template <typename Type, typename Allocator, typename TailPolicy, typename StatsPolicy, typename InlinePolicy, typename FingerprintPolicy, typename IndexPolicy>
+CUSTOM_LIST_CONSTEXPR bool operator==(const SingleLinkedList<Type, Allocator, TailPolicy, StatsPolicy, InlinePolicy, FingerprintPolicy, IndexPolicy>& lhs, const SingleLinkedList<Type, Allocator, TailPolicy, StatsPolicy, InlinePolicy, FingerprintPolicy, IndexPolicy>& rhs)
+{
+    if (&lhs == &rhs)
+    {
+        return true;
+    }
+    if (lhs.size() != rhs.size())
+    {
+        return false;
+    }
+    if constexpr (FingerprintPolicy::enabled)
+    {
+        if (lhs.hash() != rhs.hash())
+        {
+            return false;
+        }
+    }
+    return std::equal(lhs.begin(), lhs.end(), rhs.begin());
+}
+
+template <typename Type, typename Allocator, typename TailPolicy, typename StatsPolicy, typename InlinePolicy, typename FingerprintPolicy, typename IndexPolicy>
+CUSTOM_LIST_CONSTEXPR bool operator!=(const SingleLinkedList<Type, Allocator, TailPolicy, StatsPolicy, InlinePolicy, FingerprintPolicy, IndexPolicy>& lhs, const SingleLinkedList<Type, Allocator, TailPolicy, StatsPolicy, InlinePolicy, FingerprintPolicy, IndexPolicy>& rhs)
+{
+    return !(lhs == rhs);
+}
+
+template <typename Type, typename Allocator, typename TailPolicy, typename StatsPolicy, typename InlinePolicy, typename FingerprintPolicy, typename IndexPolicy>
+CUSTOM_LIST_CONSTEXPR bool operator<(const SingleLinkedList<Type, Allocator, TailPolicy, StatsPolicy, InlinePolicy, FingerprintPolicy, IndexPolicy>& lhs, const SingleLinkedList<Type, Allocator, TailPolicy, StatsPolicy, InlinePolicy, FingerprintPolicy, IndexPolicy>& rhs)
+{
+    return std::lexicographical_compare(lhs.begin(), lhs.end(), rhs.begin(), rhs.end());
+}
+
+template <typename Type, typename Allocator, typename TailPolicy, typename StatsPolicy, typename InlinePolicy, typename FingerprintPolicy, typename IndexPolicy>
+CUSTOM_LIST_CONSTEXPR bool operator<=(const SingleLinkedList<Type, Allocator, TailPolicy, StatsPolicy, InlinePolicy, FingerprintPolicy, IndexPolicy>& lhs, const SingleLinkedList<Type, Allocator, TailPolicy, StatsPolicy, InlinePolicy, FingerprintPolicy, IndexPolicy>& rhs)
+{
+    return !(lhs > rhs);
+}
+
+template <typename Type, typename Allocator, typename TailPolicy, typename StatsPolicy, typename InlinePolicy, typename FingerprintPolicy, typename IndexPolicy>
+CUSTOM_LIST_CONSTEXPR bool operator>(const SingleLinkedList<Type, Allocator, TailPolicy, StatsPolicy, InlinePolicy, FingerprintPolicy, IndexPolicy>& lhs, const SingleLinkedList<Type, Allocator, TailPolicy, StatsPolicy, InlinePolicy, FingerprintPolicy, IndexPolicy>& rhs)
+{
+    return rhs < lhs;
+}
+
+template <typename Type, typename Allocator, typename TailPolicy, typename StatsPolicy, typename InlinePolicy, typename FingerprintPolicy, typename IndexPolicy>
+CUSTOM_LIST_CONSTEXPR bool operator>=(const SingleLinkedList<Type, Allocator, TailPolicy, StatsPolicy, InlinePolicy, FingerprintPolicy, IndexPolicy>& lhs, const SingleLinkedList<Type, Allocator, TailPolicy, StatsPolicy, InlinePolicy, FingerprintPolicy, IndexPolicy>& rhs)
+{
+    return !(lhs < rhs);
+}
+
+// Copies the elements of list into an array, which must have room for exactly all of them.
+// Lists cannot outlive constant evaluation, so a table computed at compile time is moved
+// into static storage this way:
+//     constexpr auto kTable = ToArray<MakeTable().size()>(MakeTable());
+template <size_t Size, typename List>
+[[nodiscard]] CUSTOM_LIST_CONSTEXPR std::array<typename List::value_type, Size> ToArray(const List& list)
+{
+    assert(list.size() == Size);
+
+    std::array<typename List::value_type, Size> result{};
+    std::copy(list.begin(), list.end(), result.begin());
+    return result;
+}
+
+#if CUSTOM_LIST_RANGES
+// Pipe targets returned by ToList(). A view pipeline ending in one runs as a single pass that
+// allocates nothing but the nodes of the result:
+//     auto list = values | std::views::filter(is_even) | std::views::take(10) | ToList();
+struct ListSink
+{
+    template <std::ranges::input_range Range>
+    [[nodiscard]] CUSTOM_LIST_CONSTEXPR auto operator()(Range&& range) const
+    {
+        return SingleLinkedList<std::ranges::range_value_t<Range>>(kFromRange, std::forward<Range>(range));
+    }
+};
+
+template <typename List>
+struct TypedListSink
+{
+    typename List::allocator_type alloc;
+
+    template <std::ranges::input_range Range>
+    [[nodiscard]] CUSTOM_LIST_CONSTEXPR List operator()(Range&& range) const
+    {
+        return List(kFromRange, std::forward<Range>(range), alloc);
+    }
+};
+
+// Collects into a SingleLinkedList of the range's value type.
+[[nodiscard]] constexpr ListSink ToList() noexcept
+{
+    return {};
+}
+
+// Collects into List, a SingleLinkedList specialization, using alloc.
+template <typename List>
+[[nodiscard]] constexpr TypedListSink<List> ToList(const typename List::allocator_type& alloc = typename List::allocator_type())
+{
+    return TypedListSink<List>{ alloc };
+}
+
+template <std::ranges::input_range Range>
+[[nodiscard]] CUSTOM_LIST_CONSTEXPR auto operator|(Range&& range, ListSink sink)
+{
+    return sink(std::forward<Range>(range));
+}
+
+template <std::ranges::input_range Range, typename List>
+[[nodiscard]] CUSTOM_LIST_CONSTEXPR List operator|(Range&& range, const TypedListSink<List>& sink)
+{
+    return sink(std::forward<Range>(range));
+}
+#endif
+
+namespace std
+{
+    template <typename Type, typename Allocator, typename TailPolicy, typename StatsPolicy, typename InlinePolicy, typename FingerprintPolicy, typename IndexPolicy>
+    struct hash<SingleLinkedList<Type, Allocator, TailPolicy, StatsPolicy, InlinePolicy, FingerprintPolicy, IndexPolicy>>
+    {
+        [[nodiscard]] size_t operator()(const SingleLinkedList<Type, Allocator, TailPolicy, StatsPolicy, InlinePolicy, FingerprintPolicy, IndexPolicy>& list) const noexcept
+        {
+            return list.hash();
+        }
+    };
+}
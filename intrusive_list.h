@@ -0,0 +1,446 @@
+#pragma once
+#include <cassert>
+#include <cstddef>
+#include <iterator>
+#include <type_traits>
+#include <utility>
+#include <algorithm>
+
+// Link embedded in objects stored in an IntrusiveList. Copying an object does not copy
+// its membership: a copied hook starts out unlinked and assigning to a hook leaves it as is.
+struct IntrusiveListHook
+{
+    IntrusiveListHook() = default;
+    IntrusiveListHook(const IntrusiveListHook&) noexcept {}
+    IntrusiveListHook& operator=(const IntrusiveListHook&) noexcept
+    {
+        return *this;
+    }
+
+    IntrusiveListHook* next_hook = nullptr;
+};
+
+// Hook that also remembers which link points at it. That costs one more pointer and buys
+// O(1) unlinking of an element without knowing its predecessor, plus debug-build checks
+// against inserting an element that is already linked, unlinking one that is not, and
+// destroying one that is still in a list. It holds its link as the first member rather than
+// deriving from IntrusiveListHook, so that it is standard-layout like the plain hook and can
+// be a member of a standard-layout type.
+struct SafeIntrusiveListHook
+{
+    SafeIntrusiveListHook() = default;
+    SafeIntrusiveListHook(const SafeIntrusiveListHook&) noexcept {}
+    SafeIntrusiveListHook& operator=(const SafeIntrusiveListHook&) noexcept
+    {
+        return *this;
+    }
+
+    ~SafeIntrusiveListHook()
+    {
+        assert(!is_linked());
+    }
+
+    [[nodiscard]] bool is_linked() const noexcept
+    {
+        return link_to_this != nullptr;
+    }
+
+    IntrusiveListHook link;
+    IntrusiveListHook** link_to_this = nullptr;
+};
+
+static_assert(std::is_standard_layout_v<IntrusiveListHook> && std::is_standard_layout_v<SafeIntrusiveListHook>);
+
+// Hook accessor for types that derive from the hook. Picks the safe hook when Type has one.
+template <typename Type,
+    typename Hook = std::conditional_t<std::is_base_of_v<SafeIntrusiveListHook, Type>, SafeIntrusiveListHook, IntrusiveListHook>>
+struct BaseHook
+{
+    using hook_type = Hook;
+
+    [[nodiscard]] static Hook* to_hook(Type* value) noexcept
+    {
+        return static_cast<Hook*>(value);
+    }
+
+    [[nodiscard]] static Type* to_value(Hook* hook) noexcept
+    {
+        return static_cast<Type*>(hook);
+    }
+};
+
+// Hook accessor for types that hold the hook as the data member Member, which starts Offset
+// bytes into Type. Offset is what offsetof gives, which is only portable for standard-layout
+// types, so Type must be one:
+//     MemberHook<Item, IntrusiveListHook, &Item::hook, offsetof(Item, hook)>
+template <typename Type, typename Hook, Hook Type::*Member, size_t Offset>
+struct MemberHook
+{
+    static_assert(std::is_standard_layout_v<Type>, "MemberHook requires a standard-layout type");
+    static_assert(Offset % alignof(Hook) == 0 && Offset + sizeof(Hook) <= sizeof(Type), "Offset cannot be that of a Hook member");
+
+    using hook_type = Hook;
+
+    [[nodiscard]] static Hook* to_hook(Type* value) noexcept
+    {
+        Hook* hook = &(value->*Member);
+        assert(reinterpret_cast<char*>(hook) - reinterpret_cast<char*>(value) == static_cast<std::ptrdiff_t>(Offset));
+        return hook;
+    }
+
+    [[nodiscard]] static Type* to_value(Hook* hook) noexcept
+    {
+        return reinterpret_cast<Type*>(reinterpret_cast<char*>(hook) - Offset);
+    }
+};
+
+// Singly linked list over objects that embed an IntrusiveListHook. The list never allocates
+// or copies: it links the caller's objects, which must outlive their membership, and it
+// never destroys them. An object can be in one list per hook at a time.
+template <typename Type, typename HookAccessor = BaseHook<Type>>
+class IntrusiveList
+{
+    using Hook = typename HookAccessor::hook_type;
+    static constexpr bool kSafeHook = std::is_same_v<Hook, SafeIntrusiveListHook>;
+
+    static_assert(kSafeHook || std::is_same_v<Hook, IntrusiveListHook>, "the hook must be IntrusiveListHook or SafeIntrusiveListHook");
+
+    template <typename ValueType>
+    class BasicIterator
+    {
+
+        friend class IntrusiveList;
+
+        explicit BasicIterator(IntrusiveListHook* node) : node_(node) {}
+
+    public:
+
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = Type;
+        using difference_type = std::ptrdiff_t;
+        using pointer = ValueType*;
+        using reference = ValueType&;
+
+        BasicIterator() = default;
+
+        BasicIterator(const BasicIterator<Type>& other) noexcept : node_(other.node_) {}
+
+        BasicIterator& operator=(const BasicIterator& rhs) = default;
+
+
+        [[nodiscard]] bool operator==(const BasicIterator<const Type>& rhs) const noexcept
+        {
+            return this->node_ == rhs.node_;
+        }
+
+        [[nodiscard]] bool operator!=(const BasicIterator<const Type>& rhs) const noexcept
+        {
+            return !(this->node_ == rhs.node_);
+        }
+
+        [[nodiscard]] bool operator==(const BasicIterator<Type>& rhs) const noexcept
+        {
+            return this->node_ == rhs.node_;
+        }
+
+        [[nodiscard]] bool operator!=(const BasicIterator<Type>& rhs) const noexcept
+        {
+            return !(this->node_ == rhs.node_);
+        }
+
+        BasicIterator& operator++() noexcept
+        {
+            assert(node_ != nullptr);
+
+            node_ = node_->next_hook;
+            return *this;
+        }
+
+        BasicIterator operator++(int) noexcept
+        {
+            assert(node_ != nullptr);
+
+            auto old_value(*this);
+            ++(*this);
+            return old_value;
+        }
+
+        [[nodiscard]] reference operator*() const noexcept
+        {
+            assert(node_ != nullptr);
+
+            return *HookAccessor::to_value(hook_of(node_));
+        }
+
+        [[nodiscard]] pointer operator->() const noexcept
+        {
+            assert(node_ != nullptr);
+
+            return HookAccessor::to_value(hook_of(node_));
+        }
+
+    private:
+        IntrusiveListHook* node_ = nullptr;
+    };
+
+public:
+    IntrusiveList() = default;
+
+    IntrusiveList(const IntrusiveList&) = delete;
+    IntrusiveList& operator=(const IntrusiveList&) = delete;
+
+    IntrusiveList(IntrusiveList&& other) noexcept
+    {
+        steal_links(other);
+    }
+
+    IntrusiveList& operator=(IntrusiveList&& rhs) noexcept
+    {
+        if (this != &rhs)
+        {
+            clear();
+            steal_links(rhs);
+        }
+        return *this;
+    }
+
+    ~IntrusiveList()
+    {
+        clear();
+    }
+
+    using value_type = Type;
+    using reference = value_type&;
+    using const_reference = const value_type&;
+    using Iterator = BasicIterator<Type>;
+    using ConstIterator = BasicIterator<const Type>;
+
+    [[nodiscard]] Iterator begin() noexcept
+    {
+        return Iterator{ head_.next_hook };
+    }
+
+    [[nodiscard]] Iterator end() noexcept
+    {
+        return Iterator{ nullptr };
+    }
+
+    [[nodiscard]] ConstIterator begin() const noexcept
+    {
+        return cbegin();
+    }
+
+    [[nodiscard]] ConstIterator end() const noexcept
+    {
+        return cend();
+    }
+
+    [[nodiscard]] ConstIterator cbegin() const noexcept
+    {
+        return ConstIterator{ head_.next_hook };
+    }
+
+    [[nodiscard]] ConstIterator cend() const noexcept
+    {
+        return ConstIterator{ nullptr };
+    }
+
+    [[nodiscard]] Iterator before_begin() noexcept
+    {
+        return Iterator{ &head_ };
+    }
+
+    [[nodiscard]] ConstIterator cbefore_begin() const noexcept
+    {
+        return ConstIterator{ const_cast<IntrusiveListHook*>(&head_) };
+    }
+
+    [[nodiscard]] ConstIterator before_begin() const noexcept
+    {
+        return cbefore_begin();
+    }
+
+    // Returns an iterator to value, which must be linked into this list.
+    [[nodiscard]] Iterator iterator_to(Type& value) noexcept
+    {
+        return Iterator{ link_of(HookAccessor::to_hook(&value)) };
+    }
+
+    [[nodiscard]] ConstIterator iterator_to(const Type& value) const noexcept
+    {
+        return ConstIterator{ link_of(HookAccessor::to_hook(const_cast<Type*>(&value))) };
+    }
+
+    // Links value after pos.
+    Iterator insert(ConstIterator pos, Type& value) noexcept
+    {
+        assert(pos.node_ != nullptr);
+
+        Hook* hook = HookAccessor::to_hook(&value);
+        link_after(pos.node_, hook);
+        ++size_;
+        return Iterator{ link_of(hook) };
+    }
+
+    // Unlinks the element after pos; the element itself is left alive.
+    Iterator erase(ConstIterator pos) noexcept
+    {
+        assert(!empty());
+        assert(pos.node_ != nullptr && pos.node_->next_hook != nullptr);
+
+        unlink(&pos.node_->next_hook);
+        --size_;
+        return Iterator{ pos.node_->next_hook };
+    }
+
+    // Unlinks value, which must be in this list, in O(1) without knowing its predecessor.
+    // Only available with SafeIntrusiveListHook, which records the link pointing at it.
+    void erase(Type& value) noexcept
+    {
+        static_assert(kSafeHook, "erasing by value requires SafeIntrusiveListHook");
+        Hook* hook = HookAccessor::to_hook(&value);
+        assert(hook->is_linked());
+
+        unlink(hook->link_to_this);
+        --size_;
+    }
+
+    void swap(IntrusiveList& other) noexcept
+    {
+        std::swap(other.head_.next_hook, head_.next_hook);
+        std::swap(other.size_, size_);
+        other.relink_first();
+        relink_first();
+    }
+
+    [[nodiscard]] size_t size() const noexcept
+    {
+        return size_;
+    }
+
+    [[nodiscard]] bool empty() const noexcept
+    {
+        return size_ == 0;
+    }
+
+    void push_front(Type& value) noexcept
+    {
+        insert(cbefore_begin(), value);
+    }
+
+    void pop_front() noexcept
+    {
+        assert(!empty());
+
+        erase(cbefore_begin());
+    }
+
+    // Unlinks every element. O(1) with IntrusiveListHook; with SafeIntrusiveListHook every
+    // hook is reset, which takes linear time.
+    void clear() noexcept
+    {
+        if constexpr (kSafeHook)
+        {
+            while (head_.next_hook != nullptr)
+            {
+                unlink(&head_.next_hook);
+            }
+        }
+        head_.next_hook = nullptr;
+        size_ = 0;
+    }
+
+private:
+
+    IntrusiveListHook head_;
+    size_t size_ = 0;
+
+    // The link of a hook and the hook of a link. A SafeIntrusiveListHook is standard-layout
+    // and starts with its link, so the two addresses convert into each other.
+    [[nodiscard]] static IntrusiveListHook* link_of(Hook* hook) noexcept
+    {
+        if constexpr (kSafeHook)
+        {
+            return &hook->link;
+        }
+        else
+        {
+            return hook;
+        }
+    }
+
+    [[nodiscard]] static Hook* hook_of(IntrusiveListHook* link) noexcept
+    {
+        if constexpr (kSafeHook)
+        {
+            return reinterpret_cast<Hook*>(link);
+        }
+        else
+        {
+            return link;
+        }
+    }
+
+    static void link_after(IntrusiveListHook* prev, Hook* hook) noexcept
+    {
+        if constexpr (kSafeHook)
+        {
+            assert(!hook->is_linked());
+        }
+
+        IntrusiveListHook* link = link_of(hook);
+        link->next_hook = prev->next_hook;
+        prev->next_hook = link;
+        if constexpr (kSafeHook)
+        {
+            hook->link_to_this = &prev->next_hook;
+            if (link->next_hook != nullptr)
+            {
+                hook_of(link->next_hook)->link_to_this = &link->next_hook;
+            }
+        }
+    }
+
+    // Unlinks the hook that *link points at.
+    static void unlink(IntrusiveListHook** link) noexcept
+    {
+        IntrusiveListHook* node = *link;
+        *link = node->next_hook;
+        if constexpr (kSafeHook)
+        {
+            if (node->next_hook != nullptr)
+            {
+                hook_of(node->next_hook)->link_to_this = link;
+            }
+            hook_of(node)->link_to_this = nullptr;
+            node->next_hook = nullptr;
+        }
+    }
+
+    // The first element records the address of head_, which changes when links move between lists.
+    void relink_first() noexcept
+    {
+        if constexpr (kSafeHook)
+        {
+            if (head_.next_hook != nullptr)
+            {
+                hook_of(head_.next_hook)->link_to_this = &head_.next_hook;
+            }
+        }
+    }
+
+    void steal_links(IntrusiveList& other) noexcept
+    {
+        assert(head_.next_hook == nullptr);
+
+        head_.next_hook = std::exchange(other.head_.next_hook, nullptr);
+        size_ = std::exchange(other.size_, 0);
+        relink_first();
+    }
+};
+
+template <typename Type, typename HookAccessor>
+void swap(IntrusiveList<Type, HookAccessor>& lhs, IntrusiveList<Type, HookAccessor>& rhs) noexcept
+{
+    lhs.swap(rhs);
+}
@@ -0,0 +1,57 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+
+// Fingerprint policies for SingleLinkedList. With Fingerprint the list keeps an order-sensitive
+// hash of its contents up to date as it changes, so hash() takes constant time and operator==
+// rejects most unequal lists of equal size without comparing elements. Every insertion and
+// erasure then hashes the values next to it, and std::hash<Type> must not throw.
+struct NoFingerprint
+{
+    static constexpr bool enabled = false;
+};
+
+struct Fingerprint
+{
+    static constexpr bool enabled = true;
+};
+
+// The fingerprint of a sequence is the sum, modulo 2^64, of a hash of every link: from a
+// begin marker to the first value, from each value to the next, and from the last value to
+// an end marker. Linking or unlinking a chain changes only the links at its two ends, so the
+// sum is updated in constant time at any position, while the asymmetric link hash keeps it
+// sensitive to order. Equal sequences always have equal fingerprints.
+namespace list_fingerprint
+{
+    inline constexpr uint64_t kBeginKey = 0x6a09e667f3bcc908;
+    inline constexpr uint64_t kEndKey = 0xbb67ae8584caa73b;
+
+    // Finalizer of splitmix64.
+    [[nodiscard]] constexpr uint64_t Mix(uint64_t value) noexcept
+    {
+        value ^= value >> 30;
+        value *= 0xbf58476d1ce4e5b9;
+        value ^= value >> 27;
+        value *= 0x94d049bb133111eb;
+        return value ^ value >> 31;
+    }
+
+    [[nodiscard]] constexpr uint64_t LinkHash(uint64_t from, uint64_t to) noexcept
+    {
+        return Mix(Mix(from) + to);
+    }
+
+    inline constexpr uint64_t kEmpty = LinkHash(kBeginKey, kEndKey);
+
+    template <typename Type>
+    [[nodiscard]] uint64_t ValueKey(const Type& value) noexcept
+    {
+        return Mix(static_cast<uint64_t>(std::hash<Type>{}(value)));
+    }
+
+    [[nodiscard]] constexpr size_t Finish(uint64_t fingerprint, size_t size) noexcept
+    {
+        return static_cast<size_t>(Mix(fingerprint ^ static_cast<uint64_t>(size)));
+    }
+}
@@ -0,0 +1,397 @@
+#pragma once
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <istream>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+// Binary list format, version 1. All integers are little-endian.
+//
+//   header   "SLLS", uint16 version, uint8 flags, uint8 reserved, uint32 element size,
+//            uint64 element count, uint64 checksum of the preceding header bytes
+//   chunk    uint32 payload size, payload, uint64 checksum of the payload
+//   ...
+//   end      a chunk with an empty payload
+//
+// Element values are laid out back to back across chunk boundaries. With the raw flag set,
+// each value is its object representation of element size bytes, written and read in bulk;
+// this is only valid between hosts of the same byte order, recorded in the big-endian flag.
+// Otherwise values are encoded by ListSerializer. Each chunk checksum is seeded with the
+// chunk index, so reordered, repeated or missing chunks are detected as well as damaged bytes.
+
+class ListFormatError : public std::runtime_error
+{
+public:
+    using std::runtime_error::runtime_error;
+};
+
+[[nodiscard]] inline bool IsLittleEndianHost() noexcept
+{
+    const uint16_t probe = 1;
+    unsigned char first_byte = 0;
+    std::memcpy(&first_byte, &probe, 1);
+    return first_byte == 1;
+}
+
+// Fletcher-style checksum over little-endian 64-bit words, the last one zero-padded.
+[[nodiscard]] inline uint64_t ListChecksum(const unsigned char* data, size_t size, uint64_t seed) noexcept
+{
+    uint64_t sum = seed ^ 0x9e3779b97f4a7c15u;
+    uint64_t sum_of_sums = size;
+    const bool little_endian = IsLittleEndianHost();
+    for (size_t offset = 0; offset < size; offset += 8)
+    {
+        const size_t length = std::min<size_t>(8, size - offset);
+        uint64_t word = 0;
+        if (little_endian)
+        {
+            std::memcpy(&word, data + offset, length);
+        }
+        else
+        {
+            for (size_t i = 0; i < length; ++i)
+            {
+                word |= uint64_t{ data[offset + i] } << (8 * i);
+            }
+        }
+        sum += word;
+        sum_of_sums += sum;
+    }
+    return sum ^ (sum_of_sums << 32 | sum_of_sums >> 32);
+}
+
+class ListWriter;
+class ListReader;
+
+// Customization point: encodes values of Type for the list format. Specializations provide
+//
+//   static void write(ListWriter& writer, const Type& value);
+//   static Type read(ListReader& reader);
+//
+// built from the primitives of ListWriter and ListReader, or declare raw = true to store the
+// object representation. Trivially copyable, default constructible types are raw by default.
+template <typename Type, typename = void>
+struct ListSerializer;
+
+template <typename Type>
+struct ListSerializer<Type, std::enable_if_t<std::is_trivially_copyable_v<Type> && std::is_default_constructible_v<Type>>>
+{
+    static constexpr bool raw = true;
+};
+
+template <typename Type, typename = void>
+struct IsRawListSerializer : std::false_type
+{
+};
+
+template <typename Type>
+struct IsRawListSerializer<Type, std::void_t<decltype(ListSerializer<Type>::raw)>> : std::bool_constant<ListSerializer<Type>::raw>
+{
+};
+
+template <typename Type>
+inline constexpr bool kRawListSerializer = IsRawListSerializer<Type>::value;
+
+namespace list_format
+{
+    inline constexpr char kMagic[4] = { 'S', 'L', 'L', 'S' };
+    inline constexpr uint16_t kVersion = 1;
+    inline constexpr uint8_t kRawFlag = 1;
+    inline constexpr uint8_t kBigEndianFlag = 2;
+    inline constexpr size_t kHeaderSize = 4 + 2 + 1 + 1 + 4 + 8;
+    inline constexpr size_t kDefaultChunkBytes = size_t{ 256 } << 10;
+    inline constexpr size_t kMaxChunkBytes = size_t{ 64 } << 20;
+
+    template <typename Integer>
+    void StoreLittleEndian(unsigned char* bytes, Integer value) noexcept
+    {
+        for (size_t i = 0; i < sizeof(Integer); ++i)
+        {
+            bytes[i] = static_cast<unsigned char>(static_cast<uint64_t>(value) >> (8 * i));
+        }
+    }
+
+    template <typename Integer>
+    [[nodiscard]] Integer LoadLittleEndian(const unsigned char* bytes) noexcept
+    {
+        uint64_t value = 0;
+        for (size_t i = 0; i < sizeof(Integer); ++i)
+        {
+            value |= uint64_t{ bytes[i] } << (8 * i);
+        }
+        return static_cast<Integer>(value);
+    }
+}
+
+// Writes the list format to a stream, buffering up to chunk_bytes of payload per chunk.
+class ListWriter
+{
+public:
+    template <typename Type>
+    static ListWriter begin(std::ostream& out, size_t count, size_t chunk_bytes = list_format::kDefaultChunkBytes)
+    {
+        return ListWriter(out, count, kRawListSerializer<Type> ? sizeof(Type) : 0, chunk_bytes);
+    }
+
+    void write_bytes(const void* data, size_t size)
+    {
+        const auto* bytes = static_cast<const unsigned char*>(data);
+        while (size > 0)
+        {
+            if (used_ == buffer_.size())
+            {
+                flush_chunk();
+            }
+            const size_t length = std::min(size, buffer_.size() - used_);
+            std::memcpy(buffer_.data() + used_, bytes, length);
+            used_ += length;
+            bytes += length;
+            size -= length;
+        }
+    }
+
+    template <typename Integer>
+    void write_integer(Integer value)
+    {
+        static_assert(std::is_integral_v<Integer>);
+        unsigned char bytes[sizeof(Integer)];
+        list_format::StoreLittleEndian(bytes, value);
+        write_bytes(bytes, sizeof(bytes));
+    }
+
+    template <typename Type>
+    void write_value(const Type& value)
+    {
+        if constexpr (kRawListSerializer<Type>)
+        {
+            write_bytes(&value, sizeof(Type));
+        }
+        else
+        {
+            ListSerializer<Type>::write(*this, value);
+        }
+    }
+
+    // Flushes the last chunk and writes the end marker.
+    void finish()
+    {
+        if (used_ > 0)
+        {
+            flush_chunk();
+        }
+        flush_chunk();
+        out_.flush();
+        check_stream();
+    }
+
+private:
+    std::ostream& out_;
+    std::vector<unsigned char> buffer_;
+    size_t used_ = 0;
+    uint64_t chunk_index_ = 0;
+
+    ListWriter(std::ostream& out, size_t count, size_t element_size, size_t chunk_bytes)
+        : out_(out), buffer_(std::clamp<size_t>(chunk_bytes, 1, list_format::kMaxChunkBytes))
+    {
+        unsigned char header[list_format::kHeaderSize + 8];
+        std::memcpy(header, list_format::kMagic, 4);
+        list_format::StoreLittleEndian<uint16_t>(header + 4, list_format::kVersion);
+        header[6] = static_cast<unsigned char>((element_size != 0 ? list_format::kRawFlag : 0) | (IsLittleEndianHost() ? 0 : list_format::kBigEndianFlag));
+        header[7] = 0;
+        list_format::StoreLittleEndian<uint32_t>(header + 8, static_cast<uint32_t>(element_size));
+        list_format::StoreLittleEndian<uint64_t>(header + 12, static_cast<uint64_t>(count));
+        list_format::StoreLittleEndian<uint64_t>(header + list_format::kHeaderSize, ListChecksum(header, list_format::kHeaderSize, 0));
+        out_.write(reinterpret_cast<const char*>(header), sizeof(header));
+        check_stream();
+    }
+
+    void flush_chunk()
+    {
+        unsigned char size_bytes[4];
+        unsigned char checksum_bytes[8];
+        list_format::StoreLittleEndian<uint32_t>(size_bytes, static_cast<uint32_t>(used_));
+        list_format::StoreLittleEndian<uint64_t>(checksum_bytes, ListChecksum(buffer_.data(), used_, ++chunk_index_));
+        out_.write(reinterpret_cast<const char*>(size_bytes), sizeof(size_bytes));
+        out_.write(reinterpret_cast<const char*>(buffer_.data()), static_cast<std::streamsize>(used_));
+        out_.write(reinterpret_cast<const char*>(checksum_bytes), sizeof(checksum_bytes));
+        used_ = 0;
+        check_stream();
+    }
+
+    void check_stream()
+    {
+        if (!out_)
+        {
+            throw ListFormatError("list serialization: write failed");
+        }
+    }
+};
+
+// Reads the list format from a stream one chunk at a time, verifying each chunk before any
+// of its bytes are handed out, so memory use is bounded by the chunk size, not the list size.
+class ListReader
+{
+public:
+    template <typename Type>
+    static ListReader begin(std::istream& in)
+    {
+        return ListReader(in, kRawListSerializer<Type> ? sizeof(Type) : 0);
+    }
+
+    [[nodiscard]] size_t count() const noexcept
+    {
+        return count_;
+    }
+
+    void read_bytes(void* data, size_t size)
+    {
+        auto* bytes = static_cast<unsigned char*>(data);
+        while (size > 0)
+        {
+            if (position_ == buffer_.size() && !load_chunk())
+            {
+                throw ListFormatError("list serialization: unexpected end of data");
+            }
+            const size_t length = std::min(size, buffer_.size() - position_);
+            std::memcpy(bytes, buffer_.data() + position_, length);
+            position_ += length;
+            bytes += length;
+            size -= length;
+        }
+    }
+
+    template <typename Integer>
+    [[nodiscard]] Integer read_integer()
+    {
+        static_assert(std::is_integral_v<Integer>);
+        unsigned char bytes[sizeof(Integer)];
+        read_bytes(bytes, sizeof(bytes));
+        return list_format::LoadLittleEndian<Integer>(bytes);
+    }
+
+    template <typename Type>
+    [[nodiscard]] Type read_value()
+    {
+        if constexpr (kRawListSerializer<Type>)
+        {
+            Type value;
+            read_bytes(&value, sizeof(Type));
+            return value;
+        }
+        else
+        {
+            return ListSerializer<Type>::read(*this);
+        }
+    }
+
+    // Checks that every payload byte was consumed and the end marker follows.
+    void finish()
+    {
+        if (position_ != buffer_.size() || load_chunk())
+        {
+            throw ListFormatError("list serialization: trailing data after the last element");
+        }
+    }
+
+private:
+    std::istream& in_;
+    std::vector<unsigned char> buffer_;
+    size_t position_ = 0;
+    size_t count_ = 0;
+    uint64_t chunk_index_ = 0;
+
+    ListReader(std::istream& in, size_t element_size) : in_(in)
+    {
+        unsigned char header[list_format::kHeaderSize + 8];
+        read_stream(header, sizeof(header));
+        if (std::memcmp(header, list_format::kMagic, 4) != 0)
+        {
+            throw ListFormatError("list serialization: not a serialized list");
+        }
+        if (list_format::LoadLittleEndian<uint64_t>(header + list_format::kHeaderSize) != ListChecksum(header, list_format::kHeaderSize, 0))
+        {
+            throw ListFormatError("list serialization: header checksum mismatch");
+        }
+        if (list_format::LoadLittleEndian<uint16_t>(header + 4) != list_format::kVersion)
+        {
+            throw ListFormatError("list serialization: unsupported format version");
+        }
+
+        const uint8_t flags = header[6];
+        const bool raw = (flags & list_format::kRawFlag) != 0;
+        if (raw != (element_size != 0) || list_format::LoadLittleEndian<uint32_t>(header + 8) != element_size)
+        {
+            throw ListFormatError("list serialization: element encoding does not match the list type");
+        }
+        if (raw && ((flags & list_format::kBigEndianFlag) != 0) == IsLittleEndianHost())
+        {
+            throw ListFormatError("list serialization: raw elements were written with a different byte order");
+        }
+        count_ = static_cast<size_t>(list_format::LoadLittleEndian<uint64_t>(header + 12));
+    }
+
+    // Loads and verifies the next chunk. Returns false at the end marker.
+    bool load_chunk()
+    {
+        unsigned char size_bytes[4];
+        read_stream(size_bytes, sizeof(size_bytes));
+        const size_t size = list_format::LoadLittleEndian<uint32_t>(size_bytes);
+        if (size > list_format::kMaxChunkBytes)
+        {
+            throw ListFormatError("list serialization: chunk too large");
+        }
+
+        buffer_.resize(size);
+        read_stream(buffer_.data(), size);
+        unsigned char checksum_bytes[8];
+        read_stream(checksum_bytes, sizeof(checksum_bytes));
+        if (list_format::LoadLittleEndian<uint64_t>(checksum_bytes) != ListChecksum(buffer_.data(), size, ++chunk_index_))
+        {
+            throw ListFormatError("list serialization: chunk checksum mismatch");
+        }
+        position_ = 0;
+        return size != 0;
+    }
+
+    void read_stream(unsigned char* data, size_t size)
+    {
+        in_.read(reinterpret_cast<char*>(data), static_cast<std::streamsize>(size));
+        if (static_cast<size_t>(in_.gcount()) != size)
+        {
+            throw ListFormatError("list serialization: unexpected end of stream");
+        }
+    }
+};
+
+template <typename Char, typename Traits, typename StringAllocator>
+struct ListSerializer<std::basic_string<Char, Traits, StringAllocator>>
+{
+    using String = std::basic_string<Char, Traits, StringAllocator>;
+
+    static void write(ListWriter& writer, const String& value)
+    {
+        writer.write_integer<uint64_t>(value.size());
+        writer.write_bytes(value.data(), value.size() * sizeof(Char));
+    }
+
+    static String read(ListReader& reader)
+    {
+        const auto size = reader.read_integer<uint64_t>();
+        String value;
+        // Grow as the bytes arrive rather than trusting the length up front.
+        constexpr size_t kStep = 4096;
+        for (uint64_t done = 0; done < size;)
+        {
+            const size_t length = static_cast<size_t>(std::min<uint64_t>(kStep, size - done));
+            value.resize(static_cast<size_t>(done) + length);
+            reader.read_bytes(value.data() + done, length * sizeof(Char));
+            done += length;
+        }
+        return value;
+    }
+};
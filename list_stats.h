@@ -0,0 +1,227 @@
+#pragma once
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+
+// Statistics policies for SingleLinkedList. NoListStats compiles every hook away and adds
+// no storage; ListStats makes each list keep a ListStatistics and also feeds the totals
+// kept for all lists of the same element type.
+struct NoListStats
+{
+    static constexpr bool enabled = false;
+};
+
+struct ListStats
+{
+    static constexpr bool enabled = true;
+};
+
+// Counters collected by a list with ListStats. Copies and moves count the element values
+// copy- or move-constructed into nodes. Insert and erase positions are recorded as their
+// distance from the front of the list in power-of-two buckets: bucket 0 holds distance 0,
+// bucket b holds [2^(b-1), 2^b), and the last bucket holds kMaxMeasuredDistance and beyond.
+// Measuring a distance walks at most kMaxMeasuredDistance nodes, so it takes bounded time.
+struct ListStatistics
+{
+    static constexpr size_t kDistanceBuckets = 8;
+    static constexpr size_t kMaxMeasuredDistance = size_t{ 1 } << (kDistanceBuckets - 2);
+
+    uint64_t allocations = 0;
+    uint64_t deallocations = 0;
+    uint64_t copies = 0;
+    uint64_t moves = 0;
+    uint64_t peak_size = 0;
+    std::array<uint64_t, kDistanceBuckets> insert_distances{};
+    std::array<uint64_t, kDistanceBuckets> erase_distances{};
+
+    [[nodiscard]] static size_t distance_bucket(size_t distance) noexcept
+    {
+        size_t bucket = 0;
+        while (distance != 0 && bucket + 1 < kDistanceBuckets)
+        {
+            distance >>= 1;
+            ++bucket;
+        }
+        return bucket;
+    }
+
+    void record_allocation() noexcept
+    {
+        ++allocations;
+    }
+
+    void record_deallocation() noexcept
+    {
+        ++deallocations;
+    }
+
+    void record_deallocations(uint64_t count) noexcept
+    {
+        deallocations += count;
+    }
+
+    void record_copy() noexcept
+    {
+        ++copies;
+    }
+
+    void record_move() noexcept
+    {
+        ++moves;
+    }
+
+    void record_size(size_t size) noexcept
+    {
+        peak_size = peak_size < size ? size : peak_size;
+    }
+
+    void record_insert(size_t distance) noexcept
+    {
+        ++insert_distances[distance_bucket(distance)];
+    }
+
+    void record_erase(size_t distance) noexcept
+    {
+        ++erase_distances[distance_bucket(distance)];
+    }
+
+    // Adds the counts of other, keeping the larger peak.
+    void merge(const ListStatistics& other) noexcept
+    {
+        allocations += other.allocations;
+        deallocations += other.deallocations;
+        copies += other.copies;
+        moves += other.moves;
+        record_size(other.peak_size);
+        for (size_t i = 0; i < kDistanceBuckets; ++i)
+        {
+            insert_distances[i] += other.insert_distances[i];
+            erase_distances[i] += other.erase_distances[i];
+        }
+    }
+
+    // Writes one "name: value" line per counter. node_size and size turn node counts into bytes.
+    void print(std::ostream& out, size_t node_size, size_t size) const
+    {
+        out << "allocations: " << allocations << "\n";
+        out << "deallocations: " << deallocations << "\n";
+        out << "copies: " << copies << "\n";
+        out << "moves: " << moves << "\n";
+        out << "size: " << size << "\n";
+        out << "peak_size: " << peak_size << "\n";
+        out << "node_bytes: " << size * node_size << "\n";
+        out << "peak_node_bytes: " << peak_size * node_size << "\n";
+        print_histogram(out, "insert_distances", insert_distances);
+        print_histogram(out, "erase_distances", erase_distances);
+    }
+
+private:
+    static void print_histogram(std::ostream& out, const char* name, const std::array<uint64_t, kDistanceBuckets>& buckets)
+    {
+        out << name << ":";
+        for (size_t i = 0; i < kDistanceBuckets; ++i)
+        {
+            const size_t low = i == 0 ? 0 : size_t{ 1 } << (i - 1);
+            out << " [" << low;
+            if (i + 1 < kDistanceBuckets)
+            {
+                out << "," << (size_t{ 1 } << i) << ")=";
+            }
+            else
+            {
+                out << ",inf)=";
+            }
+            out << buckets[i];
+        }
+        out << "\n";
+    }
+};
+
+// Totals over every list with ListStats of one element type, safe to update from many
+// threads. Here peak_size is the peak number of nodes alive at once across all those lists.
+class SharedListStatistics
+{
+public:
+    void record_allocation() noexcept
+    {
+        allocations_.fetch_add(1, std::memory_order_relaxed);
+        const uint64_t live = live_nodes_.fetch_add(1, std::memory_order_relaxed) + 1;
+        uint64_t peak = peak_nodes_.load(std::memory_order_relaxed);
+        while (peak < live && !peak_nodes_.compare_exchange_weak(peak, live, std::memory_order_relaxed))
+        {
+        }
+    }
+
+    void record_deallocation() noexcept
+    {
+        deallocations_.fetch_add(1, std::memory_order_relaxed);
+        live_nodes_.fetch_sub(1, std::memory_order_relaxed);
+    }
+
+    void record_deallocations(uint64_t count) noexcept
+    {
+        deallocations_.fetch_add(count, std::memory_order_relaxed);
+        live_nodes_.fetch_sub(count, std::memory_order_relaxed);
+    }
+
+    void record_copy() noexcept
+    {
+        copies_.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    void record_move() noexcept
+    {
+        moves_.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    void record_insert(size_t distance) noexcept
+    {
+        insert_distances_[ListStatistics::distance_bucket(distance)].fetch_add(1, std::memory_order_relaxed);
+    }
+
+    void record_erase(size_t distance) noexcept
+    {
+        erase_distances_[ListStatistics::distance_bucket(distance)].fetch_add(1, std::memory_order_relaxed);
+    }
+
+    [[nodiscard]] size_t live_nodes() const noexcept
+    {
+        return static_cast<size_t>(live_nodes_.load(std::memory_order_relaxed));
+    }
+
+    // Counters read one by one; concurrent updates may leave them mutually inconsistent.
+    [[nodiscard]] ListStatistics snapshot() const noexcept
+    {
+        ListStatistics result;
+        result.allocations = allocations_.load(std::memory_order_relaxed);
+        result.deallocations = deallocations_.load(std::memory_order_relaxed);
+        result.copies = copies_.load(std::memory_order_relaxed);
+        result.moves = moves_.load(std::memory_order_relaxed);
+        result.peak_size = peak_nodes_.load(std::memory_order_relaxed);
+        for (size_t i = 0; i < ListStatistics::kDistanceBuckets; ++i)
+        {
+            result.insert_distances[i] = insert_distances_[i].load(std::memory_order_relaxed);
+            result.erase_distances[i] = erase_distances_[i].load(std::memory_order_relaxed);
+        }
+        return result;
+    }
+
+private:
+    std::atomic<uint64_t> allocations_{ 0 };
+    std::atomic<uint64_t> deallocations_{ 0 };
+    std::atomic<uint64_t> copies_{ 0 };
+    std::atomic<uint64_t> moves_{ 0 };
+    std::atomic<uint64_t> live_nodes_{ 0 };
+    std::atomic<uint64_t> peak_nodes_{ 0 };
+    std::array<std::atomic<uint64_t>, ListStatistics::kDistanceBuckets> insert_distances_{};
+    std::array<std::atomic<uint64_t>, ListStatistics::kDistanceBuckets> erase_distances_{};
+};
+
+template <typename Type>
+[[nodiscard]] SharedListStatistics& TypeListStatistics() noexcept
+{
+    static SharedListStatistics statistics;
+    return statistics;
+}
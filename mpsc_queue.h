@@ -0,0 +1,309 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <optional>
+#include <utility>
+
+#include "custom_list.h"
+
+// Unbounded FIFO queue for many producer threads and one consumer thread, after Dmitry
+// Vyukov's intrusive MPSC queue. Nodes have the layout of SingleLinkedList nodes, a value
+// followed by the link, with the link atomic. A producer links a node in with one atomic
+// exchange on the tail and one store, so enqueueing is wait-free. The consumer owns the
+// head: it never writes what producers read, so it can take any number of elements with
+// plain acquire loads of the links, and drain() hands out everything pending in one pass.
+//
+// The head is a dummy node whose value has already been taken. Taking an element makes its
+// node the new dummy and recycles the old one onto a free list, which Producer handles
+// grab whole with one exchange, so neither side ever pops single nodes and the free list
+// has no ABA problem. Nodes stay allocated until the queue is destroyed or
+// release_free_nodes() is called; their number is bounded by the most elements ever in
+// flight at once. The allocator is called concurrently and must be thread-safe.
+//
+// An element pushed by a producer that is suspended between its exchange and its store
+// stays invisible to the consumer, together with everything pushed after it, until the
+// producer resumes.
+template <typename Type, typename Allocator = std::allocator<Type>>
+class MpscQueue
+{
+    struct Node
+    {
+        Node() noexcept {}
+        ~Node() {}
+
+        // Live only while the node holds a queued element.
+        union
+        {
+            Type value;
+        };
+        std::atomic<Node*> next_node{ nullptr };
+    };
+
+    using NodeAllocator = typename std::allocator_traits<Allocator>::template rebind_alloc<Node>;
+    using NodeAllocTraits = std::allocator_traits<NodeAllocator>;
+
+public:
+    // Pushes for a single producer thread, reusing nodes the consumer has recycled: when its
+    // own stock runs out it takes the whole free list with one exchange. Unused nodes go
+    // back to the free list when it is destroyed, which must happen before the queue is.
+    class Producer
+    {
+    public:
+        explicit Producer(MpscQueue& queue) noexcept : queue_(&queue) {}
+
+        Producer(const Producer&) = delete;
+        Producer& operator=(const Producer&) = delete;
+
+        Producer(Producer&& other) noexcept : queue_(other.queue_), stock_(std::exchange(other.stock_, nullptr)) {}
+
+        ~Producer()
+        {
+            if (stock_ != nullptr)
+            {
+                Node* last = stock_;
+                while (Node* next = last->next_node.load(std::memory_order_relaxed))
+                {
+                    last = next;
+                }
+                queue_->recycle(stock_, last);
+            }
+        }
+
+        void push(const Type& value)
+        {
+            emplace(value);
+        }
+
+        void push(Type&& value)
+        {
+            emplace(std::move(value));
+        }
+
+        template <typename... Args>
+        void emplace(Args&&... args)
+        {
+            if (stock_ == nullptr)
+            {
+                stock_ = queue_->free_.exchange(nullptr, std::memory_order_acquire);
+            }
+            Node* node = stock_;
+            if (node == nullptr)
+            {
+                node = queue_->allocate_node();
+            }
+            try
+            {
+                NodeAllocTraits::construct(queue_->node_alloc_, std::addressof(node->value), std::forward<Args>(args)...);
+            }
+            catch (...)
+            {
+                if (node != stock_)
+                {
+                    queue_->deallocate_node(node);
+                }
+                throw;
+            }
+            if (node == stock_)
+            {
+                stock_ = node->next_node.load(std::memory_order_relaxed);
+            }
+            queue_->publish(node);
+        }
+
+    private:
+        MpscQueue* queue_;
+        Node* stock_ = nullptr;
+    };
+
+    explicit MpscQueue(const Allocator& alloc = Allocator()) : node_alloc_(alloc)
+    {
+        head_ = allocate_node();
+        tail_.store(head_, std::memory_order_relaxed);
+    }
+
+    MpscQueue(const MpscQueue&) = delete;
+    MpscQueue& operator=(const MpscQueue&) = delete;
+
+    ~MpscQueue()
+    {
+        Node* node = head_->next_node.load(std::memory_order_acquire);
+        deallocate_node(head_);
+        while (node != nullptr)
+        {
+            NodeAllocTraits::destroy(node_alloc_, std::addressof(node->value));
+            deallocate_node(std::exchange(node, node->next_node.load(std::memory_order_acquire)));
+        }
+        release_free_nodes();
+    }
+
+    using value_type = Type;
+    using allocator_type = Allocator;
+
+    [[nodiscard]] Producer producer() noexcept
+    {
+        return Producer(*this);
+    }
+
+    // Pushes in a freshly allocated node, from any thread. Threads that push often should
+    // use a Producer instead.
+    void push(const Type& value)
+    {
+        emplace(value);
+    }
+
+    void push(Type&& value)
+    {
+        emplace(std::move(value));
+    }
+
+    template <typename... Args>
+    void emplace(Args&&... args)
+    {
+        Node* node = allocate_node();
+        try
+        {
+            NodeAllocTraits::construct(node_alloc_, std::addressof(node->value), std::forward<Args>(args)...);
+        }
+        catch (...)
+        {
+            deallocate_node(node);
+            throw;
+        }
+        publish(node);
+    }
+
+    // The remaining members are for the consumer thread only.
+
+    [[nodiscard]] bool empty() const noexcept
+    {
+        return head_->next_node.load(std::memory_order_acquire) == nullptr;
+    }
+
+    // Takes the oldest element, if one is visible. If moving it out throws, it stays queued.
+    [[nodiscard]] std::optional<Type> try_pop()
+    {
+        Node* next = head_->next_node.load(std::memory_order_acquire);
+        if (next == nullptr)
+        {
+            return std::nullopt;
+        }
+
+        std::optional<Type> result(std::move(next->value));
+        NodeAllocTraits::destroy(node_alloc_, std::addressof(next->value));
+        Node* old_head = std::exchange(head_, next);
+        recycle(old_head, old_head);
+        return result;
+    }
+
+    // Passes every element pushed before the call, and visible by then, to func in FIFO
+    // order and returns their number. The drained nodes are recycled with a single
+    // operation at the end. If func throws, the element it was given counts as taken and
+    // the rest stay queued.
+    template <typename Function>
+    size_t drain(Function func)
+    {
+        Node* const last = tail_.load(std::memory_order_acquire);
+        Node* const first_drained = head_;
+        Node* last_drained = nullptr;
+        size_t count = 0;
+        try
+        {
+            while (head_ != last)
+            {
+                Node* next = head_->next_node.load(std::memory_order_acquire);
+                if (next == nullptr)
+                {
+                    break;
+                }
+                last_drained = std::exchange(head_, next);
+                ++count;
+                ValueGuard taken{ *this, next };
+                func(std::move(next->value));
+            }
+        }
+        catch (...)
+        {
+            recycle(first_drained, last_drained);
+            throw;
+        }
+        if (last_drained != nullptr)
+        {
+            recycle(first_drained, last_drained);
+        }
+        return count;
+    }
+
+    // Takes everything drain() would, as a list in FIFO order that allocates with a copy of
+    // the queue's allocator.
+    [[nodiscard]] SingleLinkedList<Type, Allocator> drain()
+    {
+        SingleLinkedList<Type, Allocator> result((Allocator(node_alloc_)));
+        auto last = result.before_begin();
+        drain([&result, &last](Type&& value) {
+            last = result.emplace_after(last, std::move(value));
+        });
+        return result;
+    }
+
+    // Frees the nodes on the free list. Nodes held by live Producers are not affected.
+    void release_free_nodes() noexcept
+    {
+        Node* node = free_.exchange(nullptr, std::memory_order_acquire);
+        while (node != nullptr)
+        {
+            deallocate_node(std::exchange(node, node->next_node.load(std::memory_order_relaxed)));
+        }
+    }
+
+private:
+    // Producers and the consumer write to different cache lines.
+    alignas(64) std::atomic<Node*> tail_{ nullptr };
+    alignas(64) std::atomic<Node*> free_{ nullptr };
+    alignas(64) Node* head_ = nullptr;
+    CUSTOM_LIST_NO_UNIQUE_ADDRESS NodeAllocator node_alloc_;
+
+    // Destroys the value of a node taken by drain() once func is done with it.
+    struct ValueGuard
+    {
+        MpscQueue& queue;
+        Node* node;
+
+        ~ValueGuard()
+        {
+            NodeAllocTraits::destroy(queue.node_alloc_, std::addressof(node->value));
+        }
+    };
+
+    Node* allocate_node()
+    {
+        Node* node = NodeAllocTraits::allocate(node_alloc_, 1);
+        NodeAllocTraits::construct(node_alloc_, node);
+        return node;
+    }
+
+    void deallocate_node(Node* node) noexcept
+    {
+        NodeAllocTraits::destroy(node_alloc_, node);
+        NodeAllocTraits::deallocate(node_alloc_, node, 1);
+    }
+
+    // Appends node, whose value is constructed, at the tail.
+    void publish(Node* node) noexcept
+    {
+        node->next_node.store(nullptr, std::memory_order_relaxed);
+        Node* prev = tail_.exchange(node, std::memory_order_acq_rel);
+        prev->next_node.store(node, std::memory_order_release);
+    }
+
+    // Pushes the chain from first to last, already linked, onto the free list.
+    // The previous dummy and the drained nodes after it are such a chain.
+    void recycle(Node* first, Node* last) noexcept
+    {
+        Node* top = free_.load(std::memory_order_relaxed);
+        do
+        {
+            last->next_node.store(top, std::memory_order_relaxed);
+        } while (!free_.compare_exchange_weak(top, first, std::memory_order_release, std::memory_order_relaxed));
+    }
+};
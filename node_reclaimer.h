@@ -0,0 +1,131 @@
+#pragma once
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <utility>
+
+// Background thread that frees detached node chains, so that dropping a large list does not
+// stall the thread that drops it. Work comes as steps, each freeing at most batch_size()
+// nodes; the thread runs one step of the oldest job at a time and moves an unfinished job to
+// the back of the queue, so a huge chain cannot hold up the ones queued after it.
+class NodeReclaimer
+{
+public:
+    static constexpr size_t kDefaultBatchSize = 4096;
+
+    // Step of a job: frees up to batch_size nodes and returns true while nodes remain. Steps
+    // run on the reclaimer thread and must not throw.
+    using Step = std::function<bool(size_t batch_size)>;
+
+    explicit NodeReclaimer(size_t batch_size = kDefaultBatchSize)
+        : batch_size_(batch_size > 0 ? batch_size : 1)
+        , worker_([this]() {
+            work();
+        })
+    {
+    }
+
+    NodeReclaimer(const NodeReclaimer&) = delete;
+    NodeReclaimer& operator=(const NodeReclaimer&) = delete;
+
+    // Finishes all queued jobs, then joins the thread.
+    ~NodeReclaimer()
+    {
+        {
+            std::lock_guard lock(mutex_);
+            stopping_ = true;
+        }
+        wake_.notify_one();
+        worker_.join();
+    }
+
+    // Process-wide reclaimer, created on first use.
+    [[nodiscard]] static NodeReclaimer& shared()
+    {
+        static NodeReclaimer reclaimer;
+        return reclaimer;
+    }
+
+    [[nodiscard]] size_t batch_size() const noexcept
+    {
+        return batch_size_;
+    }
+
+    void submit(Step step)
+    {
+        {
+            std::lock_guard lock(mutex_);
+            jobs_.push_back(std::move(step));
+        }
+        wake_.notify_one();
+    }
+
+    // Blocks until every job submitted so far, and any submitted meanwhile, is finished.
+    void drain()
+    {
+        std::unique_lock lock(mutex_);
+        idle_.wait(lock, [this]() {
+            return jobs_.empty() && !busy_;
+        });
+    }
+
+private:
+    const size_t batch_size_;
+    std::mutex mutex_;
+    std::condition_variable wake_;
+    std::condition_variable idle_;
+    std::deque<Step> jobs_;
+    bool busy_ = false;
+    bool stopping_ = false;
+    std::thread worker_;
+
+    void work()
+    {
+        std::unique_lock lock(mutex_);
+        for (;;)
+        {
+            wake_.wait(lock, [this]() {
+                return stopping_ || !jobs_.empty();
+            });
+            if (jobs_.empty())
+            {
+                return;
+            }
+
+            Step step = std::move(jobs_.front());
+            jobs_.pop_front();
+            busy_ = true;
+            for (;;)
+            {
+                lock.unlock();
+                const bool unfinished = step(batch_size_);
+                lock.lock();
+                if (!unfinished)
+                {
+                    break;
+                }
+                if (jobs_.empty())
+                {
+                    continue;
+                }
+                try
+                {
+                    jobs_.push_back(std::move(step));
+                    break;
+                }
+                catch (...)
+                {
+                    // Out of memory to requeue: keep going with this job instead.
+                }
+            }
+            busy_ = false;
+            if (jobs_.empty())
+            {
+                idle_.notify_all();
+            }
+        }
+    }
+};
@@ -0,0 +1,364 @@
+#pragma once
+#include <atomic>
+#include <cassert>
+#include <cstddef>
+#include <iterator>
+#include <memory>
+#include <utility>
+#include <vector>
+#include <algorithm>
+
+#include "custom_list.h"
+
+// Immutable singly linked list whose copies share structure. Nodes are reference counted
+// and never modified once linked, so copying a list is O(1), push_front allocates only the
+// new head and pop_front never touches shared nodes. Lists sharing nodes may be used from
+// different threads; a single PersistentList object, like a std::shared_ptr, may not.
+// Nodes are released iteratively, so dropping a long unshared chain cannot overflow the stack.
+template <typename Type, typename Allocator = std::allocator<Type>>
+class PersistentList
+{
+    struct Node
+    {
+        template <typename... Args>
+        explicit Node(Node* next, Args&&... args) : value(std::forward<Args>(args)...), next_node(next) {}
+
+        const Type value;
+        Node* const next_node;
+        std::atomic<size_t> ref_count{ 1 };
+    };
+
+    using NodeAllocator = typename std::allocator_traits<Allocator>::template rebind_alloc<Node>;
+    using NodeAllocTraits = std::allocator_traits<NodeAllocator>;
+
+    class ConstIteratorImpl
+    {
+
+        friend class PersistentList;
+
+        explicit ConstIteratorImpl(const Node* node) : node_(node) {}
+
+    public:
+
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = Type;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const Type*;
+        using reference = const Type&;
+
+        ConstIteratorImpl() = default;
+
+        [[nodiscard]] bool operator==(const ConstIteratorImpl& rhs) const noexcept
+        {
+            return this->node_ == rhs.node_;
+        }
+
+        [[nodiscard]] bool operator!=(const ConstIteratorImpl& rhs) const noexcept
+        {
+            return !(this->node_ == rhs.node_);
+        }
+
+        ConstIteratorImpl& operator++() noexcept
+        {
+            assert(node_ != nullptr);
+
+            node_ = node_->next_node;
+            return *this;
+        }
+
+        ConstIteratorImpl operator++(int) noexcept
+        {
+            assert(node_ != nullptr);
+
+            auto old_value(*this);
+            ++(*this);
+            return old_value;
+        }
+
+        [[nodiscard]] reference operator*() const noexcept
+        {
+            assert(node_ != nullptr);
+
+            return node_->value;
+        }
+
+        [[nodiscard]] pointer operator->() const noexcept
+        {
+            assert(node_ != nullptr);
+
+            return &node_->value;
+        }
+
+    private:
+        const Node* node_ = nullptr;
+    };
+
+public:
+    PersistentList() {}
+
+    explicit PersistentList(const Allocator& alloc) : node_alloc_(alloc) {}
+
+    PersistentList(std::initializer_list<Type> values, const Allocator& alloc = Allocator()) : node_alloc_(alloc)
+    {
+        assign(values.begin(), values.end());
+    }
+
+    template <typename ListAllocator, typename TailPolicy, typename StatsPolicy, typename InlinePolicy, typename FingerprintPolicy, typename IndexPolicy>
+    explicit PersistentList(const SingleLinkedList<Type, ListAllocator, TailPolicy, StatsPolicy, InlinePolicy, FingerprintPolicy, IndexPolicy>& list, const Allocator& alloc = Allocator()) : node_alloc_(alloc)
+    {
+        assign(list.begin(), list.end());
+    }
+
+    // Shares all nodes of other.
+    PersistentList(const PersistentList& other) noexcept : head_(other.head_), size_(other.size_), node_alloc_(other.node_alloc_)
+    {
+        retain(head_);
+    }
+
+    PersistentList(PersistentList&& other) noexcept
+        : head_(std::exchange(other.head_, nullptr)), size_(std::exchange(other.size_, 0)), node_alloc_(other.node_alloc_)
+    {
+    }
+
+    ~PersistentList()
+    {
+        release(head_);
+    }
+
+    PersistentList& operator=(const PersistentList& rhs) noexcept
+    {
+        PersistentList rhs_copy(rhs);
+        swap(rhs_copy);
+        return *this;
+    }
+
+    PersistentList& operator=(PersistentList&& rhs) noexcept
+    {
+        PersistentList rhs_copy(std::move(rhs));
+        swap(rhs_copy);
+        return *this;
+    }
+
+    using value_type = Type;
+    using allocator_type = Allocator;
+    using reference = const value_type&;
+    using const_reference = const value_type&;
+    using ConstIterator = ConstIteratorImpl;
+    using Iterator = ConstIterator;
+
+    [[nodiscard]] allocator_type get_allocator() const noexcept
+    {
+        return allocator_type(node_alloc_);
+    }
+
+    [[nodiscard]] ConstIterator begin() const noexcept
+    {
+        return ConstIterator{ head_ };
+    }
+
+    [[nodiscard]] ConstIterator end() const noexcept
+    {
+        return ConstIterator{ nullptr };
+    }
+
+    [[nodiscard]] ConstIterator cbegin() const noexcept
+    {
+        return begin();
+    }
+
+    [[nodiscard]] ConstIterator cend() const noexcept
+    {
+        return end();
+    }
+
+    [[nodiscard]] const_reference front() const noexcept
+    {
+        assert(!empty());
+
+        return head_->value;
+    }
+
+    [[nodiscard]] size_t size() const noexcept
+    {
+        return size_;
+    }
+
+    [[nodiscard]] bool empty() const noexcept
+    {
+        return size_ == 0;
+    }
+
+    // True if both lists start at the same node, and so share every element.
+    [[nodiscard]] bool shares_with(const PersistentList& other) const noexcept
+    {
+        return head_ == other.head_;
+    }
+
+    void swap(PersistentList& other) noexcept
+    {
+        std::swap(other.head_, head_);
+        std::swap(other.size_, size_);
+        std::swap(other.node_alloc_, node_alloc_);
+    }
+
+    // Allocates one node in front of the existing, possibly shared, chain.
+    void push_front(const Type& value)
+    {
+        emplace_front(value);
+    }
+
+    void push_front(Type&& value)
+    {
+        emplace_front(std::move(value));
+    }
+
+    template <typename... Args>
+    const_reference emplace_front(Args&&... args)
+    {
+        head_ = create_node(head_, std::forward<Args>(args)...);
+        ++size_;
+        return head_->value;
+    }
+
+    // Drops the first element from this list only; other lists sharing it are unaffected.
+    void pop_front() noexcept
+    {
+        assert(!empty());
+
+        Node* old_head = head_;
+        head_ = head_->next_node;
+        retain(head_);
+        release(old_head);
+        --size_;
+    }
+
+    void clear() noexcept
+    {
+        release(std::exchange(head_, nullptr));
+        size_ = 0;
+    }
+
+    template <typename ListAllocator = std::allocator<Type>>
+    [[nodiscard]] SingleLinkedList<Type, ListAllocator> to_list(const ListAllocator& alloc = ListAllocator()) const
+    {
+        SingleLinkedList<Type, ListAllocator> list(alloc);
+        auto last = list.before_begin();
+        for (const Type& value : *this)
+        {
+            last = list.insert(last, value);
+        }
+        return list;
+    }
+
+private:
+
+    Node* head_ = nullptr;
+    size_t size_ = 0;
+    CUSTOM_LIST_NO_UNIQUE_ADDRESS NodeAllocator node_alloc_;
+
+    static void retain(Node* node) noexcept
+    {
+        if (node != nullptr)
+        {
+            node->ref_count.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    // Drops one reference to node and frees every node that becomes unreferenced, walking
+    // the chain in a loop rather than recursing through next_node.
+    void release(Node* node) noexcept
+    {
+        while (node != nullptr && node->ref_count.fetch_sub(1, std::memory_order_acq_rel) == 1)
+        {
+            Node* next = node->next_node;
+            NodeAllocTraits::destroy(node_alloc_, node);
+            NodeAllocTraits::deallocate(node_alloc_, node, 1);
+            node = next;
+        }
+    }
+
+    template <typename... Args>
+    Node* create_node(Node* next, Args&&... args)
+    {
+        Node* node = NodeAllocTraits::allocate(node_alloc_, 1);
+        try
+        {
+            NodeAllocTraits::construct(node_alloc_, node, next, std::forward<Args>(args)...);
+        }
+        catch (...)
+        {
+            NodeAllocTraits::deallocate(node_alloc_, node, 1);
+            throw;
+        }
+        return node;
+    }
+
+    // Nodes are immutable once linked, so the chain is built back to front from a buffer.
+    template <typename ForwardIterator>
+    void assign(ForwardIterator from, ForwardIterator to)
+    {
+        std::vector<const Type*> values;
+        for (; from != to; ++from)
+        {
+            values.push_back(&*from);
+        }
+
+        Node* head = nullptr;
+        try
+        {
+            for (auto it = values.rbegin(); it != values.rend(); ++it)
+            {
+                head = create_node(head, **it);
+            }
+        }
+        catch (...)
+        {
+            release(head);
+            throw;
+        }
+        release(std::exchange(head_, head));
+        size_ = values.size();
+    }
+};
+
+template <typename Type, typename Allocator>
+void swap(PersistentList<Type, Allocator>& lhs, PersistentList<Type, Allocator>& rhs) noexcept
+{
+    lhs.swap(rhs);
+}
+
+template <typename Type, typename Allocator>
+bool operator==(const PersistentList<Type, Allocator>& lhs, const PersistentList<Type, Allocator>& rhs)
+{
+    return lhs.size() == rhs.size() && (lhs.shares_with(rhs) || std::equal(lhs.begin(), lhs.end(), rhs.begin()));
+}
+
+template <typename Type, typename Allocator>
+bool operator!=(const PersistentList<Type, Allocator>& lhs, const PersistentList<Type, Allocator>& rhs)
+{
+    return !(lhs == rhs);
+}
+
+template <typename Type, typename Allocator>
+bool operator<(const PersistentList<Type, Allocator>& lhs, const PersistentList<Type, Allocator>& rhs)
+{
+    return std::lexicographical_compare(lhs.begin(), lhs.end(), rhs.begin(), rhs.end());
+}
+
+template <typename Type, typename Allocator>
+bool operator<=(const PersistentList<Type, Allocator>& lhs, const PersistentList<Type, Allocator>& rhs)
+{
+    return !(rhs < lhs);
+}
+
+template <typename Type, typename Allocator>
+bool operator>(const PersistentList<Type, Allocator>& lhs, const PersistentList<Type, Allocator>& rhs)
+{
+    return rhs < lhs;
+}
+
+template <typename Type, typename Allocator>
+bool operator>=(const PersistentList<Type, Allocator>& lhs, const PersistentList<Type, Allocator>& rhs)
+{
+    return !(lhs < rhs);
+}
@@ -0,0 +1,205 @@
+#pragma once
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <vector>
+
+// Fixed-size block pool. Blocks are carved out of large chunks and recycled
+// through an intrusive free list, so the global heap is only touched when a
+// chunk runs out. Not thread-safe: a pool must be used from one thread at a time.
+class NodePool
+{
+public:
+    explicit NodePool(size_t blocks_per_chunk = 1024) : blocks_per_chunk_(blocks_per_chunk)
+    {
+        assert(blocks_per_chunk_ > 0);
+    }
+
+    NodePool(const NodePool&) = delete;
+    NodePool& operator=(const NodePool&) = delete;
+
+    ~NodePool()
+    {
+        for (const Chunk& chunk : chunks_)
+        {
+            ::operator delete(chunk.memory, std::align_val_t(chunk.alignment));
+        }
+    }
+
+    [[nodiscard]] void* allocate(size_t size, size_t alignment)
+    {
+        SizeClass& size_class = get_size_class(size, alignment);
+        if (size_class.free_list == nullptr)
+        {
+            refill(size_class);
+        }
+
+        FreeBlock* block = size_class.free_list;
+        size_class.free_list = block->next;
+        return block;
+    }
+
+    void deallocate(void* ptr, size_t size, size_t alignment) noexcept
+    {
+        SizeClass* size_class = find_size_class(block_size(size, alignment), block_alignment(alignment));
+        assert(size_class != nullptr);
+
+        FreeBlock* block = static_cast<FreeBlock*>(ptr);
+        block->next = size_class->free_list;
+        size_class->free_list = block;
+    }
+
+    [[nodiscard]] size_t chunk_count() const noexcept
+    {
+        return chunks_.size();
+    }
+
+private:
+    struct FreeBlock
+    {
+        FreeBlock* next = nullptr;
+    };
+
+    struct SizeClass
+    {
+        size_t block_size = 0;
+        size_t alignment = 0;
+        FreeBlock* free_list = nullptr;
+    };
+
+    struct Chunk
+    {
+        void* memory = nullptr;
+        size_t alignment = 0;
+    };
+
+    size_t blocks_per_chunk_;
+    std::vector<SizeClass> size_classes_;
+    std::vector<Chunk> chunks_;
+
+    [[nodiscard]] static size_t block_alignment(size_t alignment) noexcept
+    {
+        return std::max(alignment, alignof(FreeBlock));
+    }
+
+    [[nodiscard]] static size_t block_size(size_t size, size_t alignment) noexcept
+    {
+        const size_t align = block_alignment(alignment);
+        size = std::max(size, sizeof(FreeBlock));
+        return (size + align - 1) / align * align;
+    }
+
+    [[nodiscard]] SizeClass* find_size_class(size_t size, size_t alignment) noexcept
+    {
+        for (SizeClass& size_class : size_classes_)
+        {
+            if (size_class.block_size == size && size_class.alignment == alignment)
+            {
+                return &size_class;
+            }
+        }
+        return nullptr;
+    }
+
+    SizeClass& get_size_class(size_t size, size_t alignment)
+    {
+        const size_t align = block_alignment(alignment);
+        const size_t bytes = block_size(size, alignment);
+
+        if (SizeClass* size_class = find_size_class(bytes, align))
+        {
+            return *size_class;
+        }
+        size_classes_.push_back(SizeClass{ bytes, align, nullptr });
+        return size_classes_.back();
+    }
+
+    void refill(SizeClass& size_class)
+    {
+        chunks_.reserve(chunks_.size() + 1);
+
+        const size_t bytes = size_class.block_size * blocks_per_chunk_;
+        char* memory = static_cast<char*>(::operator new(bytes, std::align_val_t(size_class.alignment)));
+        chunks_.push_back(Chunk{ memory, size_class.alignment });
+
+        // Thread the blocks front to back so that consecutive allocations are adjacent in memory.
+        for (size_t i = blocks_per_chunk_; i > 0; --i)
+        {
+            FreeBlock* block = ::new (memory + (i - 1) * size_class.block_size) FreeBlock{ size_class.free_list };
+            size_class.free_list = block;
+        }
+    }
+};
+
+// Standard allocator over a shared NodePool. Single-object allocations, which is
+// what node-based containers request, are served from the pool; array allocations
+// fall back to the global heap. Rebound copies share the same pool.
+template <typename Type>
+class PoolAllocator
+{
+    template <typename Other>
+    friend class PoolAllocator;
+
+public:
+    using value_type = Type;
+    using propagate_on_container_copy_assignment = std::true_type;
+    using propagate_on_container_move_assignment = std::true_type;
+    using propagate_on_container_swap = std::true_type;
+    using is_always_equal = std::false_type;
+
+    PoolAllocator() : pool_(std::make_shared<NodePool>()) {}
+
+    explicit PoolAllocator(std::shared_ptr<NodePool> pool) noexcept : pool_(std::move(pool))
+    {
+        assert(pool_ != nullptr);
+    }
+
+    PoolAllocator(const PoolAllocator& other) noexcept = default;
+
+    template <typename Other>
+    PoolAllocator(const PoolAllocator<Other>& other) noexcept : pool_(other.pool_) {}
+
+    PoolAllocator& operator=(const PoolAllocator& rhs) noexcept = default;
+
+    [[nodiscard]] Type* allocate(size_t n)
+    {
+        if (n == 1)
+        {
+            return static_cast<Type*>(pool_->allocate(sizeof(Type), alignof(Type)));
+        }
+        return std::allocator<Type>().allocate(n);
+    }
+
+    void deallocate(Type* ptr, size_t n) noexcept
+    {
+        if (n == 1)
+        {
+            pool_->deallocate(ptr, sizeof(Type), alignof(Type));
+            return;
+        }
+        std::allocator<Type>().deallocate(ptr, n);
+    }
+
+    [[nodiscard]] const std::shared_ptr<NodePool>& pool() const noexcept
+    {
+        return pool_;
+    }
+
+    template <typename Other>
+    [[nodiscard]] bool operator==(const PoolAllocator<Other>& rhs) const noexcept
+    {
+        return pool_ == rhs.pool_;
+    }
+
+    template <typename Other>
+    [[nodiscard]] bool operator!=(const PoolAllocator<Other>& rhs) const noexcept
+    {
+        return !(*this == rhs);
+    }
+
+private:
+    std::shared_ptr<NodePool> pool_;
+};
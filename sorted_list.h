@@ -0,0 +1,300 @@
+#pragma once
+#include <cassert>
+#include <cstddef>
+#include <functional>
+#include <initializer_list>
+#include <iterator>
+#include <memory>
+#include <utility>
+
+#include "custom_list.h"
+
+// SingleLinkedList kept in ascending order of Compare. Elements are only reachable through
+// const iterators, so the order cannot be broken from outside. Searches remember a finger:
+// the last element known to precede the position they found. The next search starts there
+// instead of at the front if its value lies past the finger, so a run of ascending lookups
+// or insertions walks the list about once rather than once per call. Equivalent elements
+// keep their insertion order.
+template <typename Type, typename Compare = std::less<Type>, typename Allocator = std::allocator<Type>>
+class SortedList
+{
+public:
+    using List = SingleLinkedList<Type, Allocator>;
+    using value_type = Type;
+    using allocator_type = Allocator;
+    using const_reference = const value_type&;
+    using ConstIterator = typename List::ConstIterator;
+
+    SortedList() {}
+
+    explicit SortedList(const Compare& comp, const Allocator& alloc = Allocator()) : list_(alloc), comp_(comp) {}
+
+    // Takes over the nodes of list and sorts them.
+    explicit SortedList(List list, const Compare& comp = Compare()) : list_(std::move(list)), comp_(comp)
+    {
+        list_.sort(comp_);
+    }
+
+    SortedList(std::initializer_list<Type> values, const Compare& comp = Compare(), const Allocator& alloc = Allocator())
+        : list_(values, alloc), comp_(comp)
+    {
+        list_.sort(comp_);
+    }
+
+    // The finger refers into the source list, so copies start without one.
+    SortedList(const SortedList& other) : list_(other.list_), comp_(other.comp_) {}
+
+    SortedList(SortedList&& other) noexcept
+        : list_(std::move(other.list_)), comp_(other.comp_), finger_(std::exchange(other.finger_, ConstIterator{}))
+    {
+    }
+
+    SortedList& operator=(const SortedList& rhs)
+    {
+        SortedList rhs_copy(rhs);
+        swap(rhs_copy);
+        return *this;
+    }
+
+    SortedList& operator=(SortedList&& rhs) noexcept
+    {
+        SortedList rhs_copy(std::move(rhs));
+        swap(rhs_copy);
+        return *this;
+    }
+
+    [[nodiscard]] allocator_type get_allocator() const noexcept
+    {
+        return list_.get_allocator();
+    }
+
+    [[nodiscard]] ConstIterator begin() const noexcept
+    {
+        return list_.begin();
+    }
+
+    [[nodiscard]] ConstIterator end() const noexcept
+    {
+        return list_.end();
+    }
+
+    [[nodiscard]] ConstIterator cbegin() const noexcept
+    {
+        return list_.cbegin();
+    }
+
+    [[nodiscard]] ConstIterator cend() const noexcept
+    {
+        return list_.cend();
+    }
+
+    [[nodiscard]] ConstIterator before_begin() const noexcept
+    {
+        return list_.before_begin();
+    }
+
+    [[nodiscard]] size_t size() const noexcept
+    {
+        return list_.size();
+    }
+
+    [[nodiscard]] bool empty() const noexcept
+    {
+        return list_.empty();
+    }
+
+    [[nodiscard]] const List& list() const noexcept
+    {
+        return list_;
+    }
+
+    void swap(SortedList& other) noexcept
+    {
+        list_.swap(other.list_);
+        std::swap(comp_, other.comp_);
+        std::swap(finger_, other.finger_);
+    }
+
+    // Inserts value after the elements equivalent to it and returns an iterator to it.
+    ConstIterator insert_sorted(const Type& value)
+    {
+        return insert_after_equivalents(value);
+    }
+
+    ConstIterator insert_sorted(Type&& value)
+    {
+        return insert_after_equivalents(std::move(value));
+    }
+
+    // Inserts a batch: the elements are copied into a list of their own, which is sorted in
+    // O(k log k) and merged in with one pass over this list, O(n + k log k) in all instead of
+    // a search per element. If copying or sorting throws, this list is unchanged. If the
+    // comparator throws during the merge, the list keeps its elements and the batch's, but
+    // they may be out of order until it is cleared.
+    template <typename InputIterator>
+    void insert_sorted(InputIterator first, InputIterator last)
+    {
+        List batch(list_.get_allocator());
+        batch.insert_after(batch.cbefore_begin(), first, last);
+        batch.sort(comp_);
+        try
+        {
+            list_.merge(batch, comp_);
+        }
+        catch (...)
+        {
+            finger_ = ConstIterator{};
+            throw;
+        }
+    }
+
+    void insert_sorted(std::initializer_list<Type> values)
+    {
+        insert_sorted(values.begin(), values.end());
+    }
+
+    // First element not less than value, or end().
+    [[nodiscard]] ConstIterator lower_bound(const Type& value)
+    {
+        finger_ = before_lower_bound(value);
+        return std::next(unfinger(finger_));
+    }
+
+    // The const overloads start from the finger but leave it where it is.
+    [[nodiscard]] ConstIterator lower_bound(const Type& value) const
+    {
+        return std::next(unfinger(before_lower_bound(value)));
+    }
+
+    // First element equivalent to value, or end().
+    [[nodiscard]] ConstIterator find(const Type& value)
+    {
+        return equivalent_or_end(lower_bound(value), value);
+    }
+
+    [[nodiscard]] ConstIterator find(const Type& value) const
+    {
+        return equivalent_or_end(lower_bound(value), value);
+    }
+
+    [[nodiscard]] bool contains(const Type& value) const
+    {
+        return find(value) != end();
+    }
+
+    // Erases the element after pos and returns an iterator to the element that follows it.
+    ConstIterator erase_after(ConstIterator pos) noexcept
+    {
+        assert(pos != end() && std::next(pos) != end());
+
+        forget_if_erased(std::next(pos), std::next(pos, 2));
+        return list_.erase(pos);
+    }
+
+    // Erases every element equivalent to value and returns how many there were.
+    size_t erase(const Type& value)
+    {
+        const ConstIterator before = unfinger(before_lower_bound(value));
+        ConstIterator last = std::next(before);
+        size_t count = 0;
+        for (; last != end() && !comp_(value, *last); ++last)
+        {
+            ++count;
+        }
+        forget_if_erased(std::next(before), last);
+        list_.erase_after(before, last);
+        return count;
+    }
+
+    void pop_front() noexcept
+    {
+        assert(!empty());
+
+        forget_if_erased(begin(), std::next(begin()));
+        list_.pop_front();
+    }
+
+    void clear() noexcept
+    {
+        list_.clear();
+        finger_ = ConstIterator{};
+    }
+
+    // Hands the nodes back as a plain list, leaving this one empty.
+    [[nodiscard]] List release() noexcept
+    {
+        finger_ = ConstIterator{};
+        return std::move(list_);
+    }
+
+private:
+    List list_;
+    CUSTOM_LIST_NO_UNIQUE_ADDRESS Compare comp_{};
+    // An element that precedes the last position found, or end() if there is none.
+    ConstIterator finger_{};
+
+    template <typename Value>
+    ConstIterator insert_after_equivalents(Value&& value)
+    {
+        // Start at the finger if value does not sort before it.
+        ConstIterator before = finger_ != end() && !comp_(value, *finger_) ? finger_ : before_begin();
+        for (ConstIterator next = std::next(before); next != end() && !comp_(value, *next); ++next)
+        {
+            before = next;
+        }
+        finger_ = list_.insert(before, std::forward<Value>(value));
+        return finger_;
+    }
+
+    // The last element less than value, or end() if the first element is not.
+    [[nodiscard]] ConstIterator before_lower_bound(const Type& value) const
+    {
+        ConstIterator before = finger_ != end() && comp_(*finger_, value) ? finger_ : end();
+        for (ConstIterator next = std::next(unfinger(before)); next != end() && comp_(*next, value); ++next)
+        {
+            before = next;
+        }
+        return before;
+    }
+
+    [[nodiscard]] ConstIterator unfinger(ConstIterator before) const noexcept
+    {
+        return before != end() ? before : before_begin();
+    }
+
+    [[nodiscard]] ConstIterator equivalent_or_end(ConstIterator it, const Type& value) const
+    {
+        return it != end() && !comp_(value, *it) ? it : end();
+    }
+
+    // Drops the finger if it refers to an element in [first, last), which is about to be erased.
+    void forget_if_erased(ConstIterator first, ConstIterator last) noexcept
+    {
+        for (; first != last; ++first)
+        {
+            if (first == finger_)
+            {
+                finger_ = ConstIterator{};
+                return;
+            }
+        }
+    }
+};
+
+template <typename Type, typename Compare, typename Allocator>
+void swap(SortedList<Type, Compare, Allocator>& lhs, SortedList<Type, Compare, Allocator>& rhs) noexcept
+{
+    lhs.swap(rhs);
+}
+
+template <typename Type, typename Compare, typename Allocator>
+bool operator==(const SortedList<Type, Compare, Allocator>& lhs, const SortedList<Type, Compare, Allocator>& rhs)
+{
+    return lhs.list() == rhs.list();
+}
+
+template <typename Type, typename Compare, typename Allocator>
+bool operator!=(const SortedList<Type, Compare, Allocator>& lhs, const SortedList<Type, Compare, Allocator>& rhs)
+{
+    return !(lhs == rhs);
+}
@@ -1,6 +1,26 @@
 #pragma once
 
 #include "custom_list.h"
+#include "pool_allocator.h"
+#include "unrolled_list.h"
+#include "compact_list.h"
+#include "concurrent_stack.h"
+#include "intrusive_list.h"
+#include "mpsc_queue.h"
+#include "persistent_list.h"
+#include "sorted_list.h"
+#include "thread_pool.h"
+
+#include <atomic>
+#include <iterator>
+#include <limits>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <thread>
+#include <unordered_set>
+#include <vector>
+
 void Test0()
 {
     using namespace std;
@@ -549,6 +569,2551 @@ void Test4()
     }
 }
 
+template <typename Type>
+struct CountingAllocator
+{
+    using value_type = Type;
+
+    CountingAllocator() = default;
+    explicit CountingAllocator(int* live_counter) noexcept : live_counter_ptr(live_counter) {}
+
+    template <typename Other>
+    CountingAllocator(const CountingAllocator<Other>& other) noexcept : live_counter_ptr(other.live_counter_ptr) {}
+
+    Type* allocate(size_t n)
+    {
+        if (live_counter_ptr)
+        {
+            *live_counter_ptr += static_cast<int>(n);
+        }
+        return std::allocator<Type>().allocate(n);
+    }
+
+    void deallocate(Type* ptr, size_t n) noexcept
+    {
+        if (live_counter_ptr)
+        {
+            *live_counter_ptr -= static_cast<int>(n);
+        }
+        std::allocator<Type>().deallocate(ptr, n);
+    }
+
+    template <typename Other>
+    bool operator==(const CountingAllocator<Other>& rhs) const noexcept
+    {
+        return live_counter_ptr == rhs.live_counter_ptr;
+    }
+
+    template <typename Other>
+    bool operator!=(const CountingAllocator<Other>& rhs) const noexcept
+    {
+        return !(*this == rhs);
+    }
+
+    int* live_counter_ptr = nullptr;
+};
+
+void Test5()
+{
+    {
+        int live_nodes = 0;
+        {
+            using CountedList = SingleLinkedList<int, CountingAllocator<int>>;
+            CountedList list{ CountingAllocator<int>(&live_nodes) };
+            list.push_front(1);
+            list.push_front(2);
+            list.insert(list.cbegin(), 3);
+            assert(live_nodes == 3);
+
+            CountedList list_copy(list);
+            assert(live_nodes == 6);
+            assert(list_copy.get_allocator() == list.get_allocator());
+
+            list.pop_front();
+            list.erase(list.cbefore_begin());
+            assert(live_nodes == 4);
+
+            list_copy = list;
+            assert(live_nodes == 2);
+
+            const CountedList from_values({ 1, 2, 3 }, CountingAllocator<int>(&live_nodes));
+            assert(live_nodes == 5);
+        }
+        assert(live_nodes == 0);
+    }
+
+    {
+        using PoolList = SingleLinkedList<std::string, PoolAllocator<std::string>>;
+        auto pool = std::make_shared<NodePool>(16);
+        PoolList list{ PoolAllocator<std::string>(pool) };
+
+        for (int i = 0; i < 16; ++i)
+        {
+            list.push_front(std::to_string(i));
+        }
+        assert(list.size() == 16u);
+        assert(*list.begin() == "15"s);
+        assert(pool->chunk_count() == 1u);
+
+        for (int round = 0; round < 100; ++round)
+        {
+            list.pop_front();
+            list.push_front(std::to_string(round));
+        }
+        assert(pool->chunk_count() == 1u);
+
+        list.push_front("spill"s);
+        assert(pool->chunk_count() == 2u);
+
+        PoolList list_copy(list);
+        assert(list_copy.get_allocator() == list.get_allocator());
+        assert(std::equal(list.begin(), list.end(), list_copy.begin()));
+        assert(pool->chunk_count() == 3u);
+
+        list.clear();
+        list_copy.clear();
+        for (int i = 0; i < 34; ++i)
+        {
+            list.push_front(std::to_string(i));
+        }
+        assert(pool->chunk_count() == 3u);
+    }
+
+    {
+        using PoolList = SingleLinkedList<int, PoolAllocator<int>>;
+        PoolList first{ 1, 2, 3 };
+        PoolList second{ 4, 5 };
+        assert(first.get_allocator() != second.get_allocator());
+
+        const auto first_allocator = first.get_allocator();
+        first.swap(second);
+        assert(second.get_allocator() == first_allocator);
+        assert(second.size() == 3u && *second.begin() == 1);
+
+        first = second;
+        assert(first.get_allocator() == first_allocator);
+        assert(std::equal(first.begin(), first.end(), second.begin()));
+    }
+}
+
+void Test6()
+{
+    struct CopyCounter
+    {
+        CopyCounter() = default;
+        CopyCounter(int id, int* copy_counter) noexcept : id(id), copy_counter_ptr(copy_counter) {}
+        CopyCounter(const CopyCounter& other) : id(other.id), copy_counter_ptr(other.copy_counter_ptr)
+        {
+            if (copy_counter_ptr)
+            {
+                ++(*copy_counter_ptr);
+            }
+        }
+        CopyCounter(CopyCounter&& other) noexcept = default;
+        CopyCounter& operator=(const CopyCounter& rhs) = default;
+        CopyCounter& operator=(CopyCounter&& rhs) noexcept = default;
+
+        int id = 0;
+        int* copy_counter_ptr = nullptr;
+    };
+
+    {
+        int copies = 0;
+        SingleLinkedList<CopyCounter> list;
+        list.push_front(CopyCounter{ 1, &copies });
+        list.insert(list.cbegin(), CopyCounter{ 2, &copies });
+        auto& emplaced = list.emplace_front(3, &copies);
+        assert(&emplaced == &*list.begin());
+        const auto emplaced_pos = list.emplace_after(list.cbegin(), 4, &copies);
+        assert(emplaced_pos->id == 4);
+        assert(copies == 0);
+        assert(list.size() == 4u);
+
+        auto it = list.begin();
+        assert((it++)->id == 3);
+        assert((it++)->id == 4);
+        assert((it++)->id == 1);
+        assert((it++)->id == 2);
+        assert(it == list.end());
+
+        const auto old_begin = list.begin();
+        SingleLinkedList<CopyCounter> moved_to(std::move(list));
+        assert(copies == 0);
+        assert(moved_to.size() == 4u);
+        assert(moved_to.begin() == old_begin);
+        assert(list.empty());
+        assert(list.begin() == list.end());
+
+        SingleLinkedList<CopyCounter> assigned;
+        assigned.emplace_front(5, &copies);
+        assigned = std::move(moved_to);
+        assert(copies == 0);
+        assert(assigned.size() == 4u);
+        assert(assigned.begin() == old_begin);
+        assert(moved_to.empty());
+
+        moved_to.emplace_front(6, &copies);
+        assert(moved_to.begin()->id == 6);
+    }
+
+    {
+        static_assert(std::is_nothrow_move_constructible_v<SingleLinkedList<std::string>>);
+        static_assert(std::is_nothrow_move_assignable_v<SingleLinkedList<std::string>>);
+        static_assert(std::is_nothrow_move_assignable_v<SingleLinkedList<int, PoolAllocator<int>>>);
+
+        SingleLinkedList<std::string> list{ "one"s, "two"s };
+        std::string long_value(100, 'x');
+        const char* buffer = long_value.data();
+        list.push_front(std::move(long_value));
+        assert(list.begin()->data() == buffer);
+    }
+
+    {
+        int left_live = 0;
+        int right_live = 0;
+        {
+            using CountedList = SingleLinkedList<int, CountingAllocator<int>>;
+            CountedList left({ 1, 2, 3 }, CountingAllocator<int>(&left_live));
+            CountedList right({ 4, 5 }, CountingAllocator<int>(&right_live));
+
+            left = std::move(right);
+            assert(left_live == 2 && right_live == 0);
+            assert(left.get_allocator().live_counter_ptr == &left_live);
+            assert(right.empty());
+            assert((std::equal(left.begin(), left.end(), std::begin({ 4, 5 }))));
+        }
+        assert(left_live == 0 && right_live == 0);
+    }
+}
+
+void Test7()
+{
+    using SmallChunkList = UnrolledLinkedList<int, 4>;
+
+    {
+        SmallChunkList list;
+        assert(list.empty());
+        assert(list.begin() == list.end());
+        assert(++list.before_begin() == list.begin());
+        assert(list.chunk_count() == 0u);
+
+        for (int i = 9; i >= 0; --i)
+        {
+            list.push_front(i);
+        }
+        assert(list.size() == 10u);
+        assert((std::equal(list.begin(), list.end(), std::begin({ 0, 1, 2, 3, 4, 5, 6, 7, 8, 9 }))));
+        assert(list.chunk_count() >= 3u);
+
+        const auto inserted = list.insert(list.cbegin(), 100);
+        assert(*inserted == 100);
+        assert((list == SmallChunkList{ 0, 100, 1, 2, 3, 4, 5, 6, 7, 8, 9 }));
+
+        const auto after_erased = list.erase(list.cbegin());
+        assert(*after_erased == 1);
+        list.pop_front();
+        assert((list == SmallChunkList{ 1, 2, 3, 4, 5, 6, 7, 8, 9 }));
+
+        list.clear();
+        assert(list.empty());
+        assert(list.chunk_count() == 0u);
+    }
+
+    {
+        const SmallChunkList source{ 1, 2, 3, 4, 5, 6, 7, 8, 9 };
+        assert(source.chunk_count() == 3u);
+
+        SmallChunkList copy(source);
+        assert(copy == source);
+        assert(copy.begin() != source.begin());
+
+        SmallChunkList moved(std::move(copy));
+        assert(copy.empty());
+        assert(moved == source);
+
+        SmallChunkList assigned{ 5 };
+        assigned = source;
+        assert(assigned == source);
+        assert((SmallChunkList{ 1, 2 } < SmallChunkList{ 1, 3 }));
+        assert((SmallChunkList{ 1, 2 } != SmallChunkList{ 1, 3 }));
+    }
+
+    {
+        // Mirror random inserts and erases against a vector to exercise splits and merges.
+        SmallChunkList list;
+        std::vector<int> expected;
+        unsigned state = 12345;
+        const auto next_random = [&state]() {
+            state = state * 1103515245u + 12345u;
+            return (state >> 16) & 0x7fff;
+        };
+
+        for (int step = 0; step < 2000; ++step)
+        {
+            const size_t pos = expected.empty() ? 0 : next_random() % (expected.size() + 1);
+            auto it = list.cbefore_begin();
+            for (size_t i = 0; i < pos; ++i)
+            {
+                ++it;
+            }
+
+            if (next_random() % 3 != 0 || pos == expected.size())
+            {
+                const auto inserted = list.insert(it, step);
+                assert(*inserted == step);
+                expected.insert(expected.begin() + pos, step);
+            }
+            else
+            {
+                const auto after = list.erase(it);
+                expected.erase(expected.begin() + pos);
+                assert(pos == expected.size() ? after == list.end() : *after == expected[pos]);
+            }
+
+            assert(list.size() == expected.size());
+            assert(std::equal(list.begin(), list.end(), expected.begin(), expected.end()));
+        }
+    }
+
+    {
+        UnrolledLinkedList<std::string, 2> strings;
+        strings.push_front("world"s);
+        strings.emplace_front(3, 'a');
+        strings.emplace_after(strings.cbegin(), "hello");
+        assert((strings == UnrolledLinkedList<std::string, 2>{ "aaa"s, "hello"s, "world"s }));
+    }
+}
+
+void Test8()
+{
+    using IntList = SingleLinkedList<int>;
+    const auto contains = [](const IntList& list, std::initializer_list<int> values) {
+        return list.size() == values.size() && std::equal(list.begin(), list.end(), values.begin());
+    };
+
+    {
+        IntList list{ 1, 2, 3 };
+        IntList other{ 10, 20 };
+        list.splice_after(list.cbegin(), other);
+        assert(contains(list, { 1, 10, 20, 2, 3 }));
+        assert(other.empty() && other.begin() == other.end());
+
+        list.splice_after(list.cbefore_begin(), IntList{ 7 });
+        assert(contains(list, { 7, 1, 10, 20, 2, 3 }));
+
+        IntList empty_list;
+        list.splice_after(list.cbegin(), empty_list);
+        assert(list.size() == 6u);
+    }
+
+    {
+        IntList list{ 1, 2, 3 };
+        IntList other{ 10, 20, 30 };
+        const auto moved_node = ++other.begin();
+        list.splice_after(list.cbefore_begin(), other, other.cbegin());
+        assert(contains(list, { 20, 1, 2, 3 }));
+        assert(contains(other, { 10, 30 }));
+        assert(list.begin() == moved_node);
+
+        list.splice_after(list.cbegin(), list, ++(++list.cbegin()));
+        assert(contains(list, { 20, 3, 1, 2 }));
+    }
+
+    {
+        IntList list{ 1, 2 };
+        IntList other{ 10, 20, 30, 40 };
+        list.splice_after(list.cbegin(), other, other.cbegin(), ++(++(++other.cbegin())));
+        assert(contains(list, { 1, 20, 30, 2 }));
+        assert(contains(other, { 10, 40 }));
+
+        list.splice_after(list.cbefore_begin(), other, other.cbefore_begin(), other.cend());
+        assert(contains(list, { 10, 40, 1, 20, 30, 2 }));
+        assert(other.empty());
+    }
+
+    {
+        IntList left{ 1, 3, 5, 7 };
+        IntList right{ 0, 2, 4, 8, 9 };
+        left.merge(right);
+        assert(contains(left, { 0, 1, 2, 3, 4, 5, 7, 8, 9 }));
+        assert(right.empty());
+
+        IntList descending{ 9, 5, 1 };
+        descending.merge(IntList{ 8, 2 }, std::greater<>{});
+        assert(contains(descending, { 9, 8, 5, 2, 1 }));
+    }
+
+    {
+        using Entry = std::pair<int, int>;
+        const auto by_key = [](const Entry& lhs, const Entry& rhs) {
+            return lhs.first < rhs.first;
+        };
+
+        SingleLinkedList<Entry> left{ { 1, 0 }, { 2, 0 }, { 2, 1 } };
+        SingleLinkedList<Entry> right{ { 1, 2 }, { 2, 2 } };
+        left.merge(right, by_key);
+        assert((std::equal(left.begin(), left.end(), std::begin<std::initializer_list<Entry>>({ { 1, 0 }, { 1, 2 }, { 2, 0 }, { 2, 1 }, { 2, 2 } }))));
+
+        SingleLinkedList<Entry> unsorted{ { 3, 0 }, { 1, 0 }, { 3, 1 }, { 2, 0 }, { 1, 1 }, { 3, 2 } };
+        unsorted.sort(by_key);
+        assert((std::equal(unsorted.begin(), unsorted.end(), std::begin<std::initializer_list<Entry>>({ { 1, 0 }, { 1, 1 }, { 2, 0 }, { 3, 0 }, { 3, 1 }, { 3, 2 } }))));
+    }
+
+    {
+        IntList empty_list;
+        empty_list.sort();
+        assert(empty_list.empty());
+
+        IntList single{ 42 };
+        single.sort();
+        assert(contains(single, { 42 }));
+
+        int live_nodes = 0;
+        SingleLinkedList<int, CountingAllocator<int>> list{ CountingAllocator<int>(&live_nodes) };
+        std::vector<int> expected;
+        unsigned state = 777;
+        for (int i = 0; i < 1000; ++i)
+        {
+            state = state * 1103515245u + 12345u;
+            const int value = static_cast<int>((state >> 16) % 500);
+            list.push_front(value);
+            expected.push_back(value);
+        }
+        const auto nodes_before_sort = live_nodes;
+        list.sort();
+        std::sort(expected.begin(), expected.end());
+        assert(live_nodes == nodes_before_sort);
+        assert(list.size() == expected.size());
+        assert(std::equal(list.begin(), list.end(), expected.begin(), expected.end()));
+
+        list.push_front(-1);
+        assert(*list.begin() == -1);
+    }
+
+    {
+        // A comparator that throws partway through leaves every node in a list that knows
+        // its size and last node.
+        struct ThrowingLess
+        {
+            int* calls_left;
+
+            bool operator()(int lhs, int rhs) const
+            {
+                if (--*calls_left == 0)
+                {
+                    throw std::runtime_error("comparison failed");
+                }
+                return lhs < rhs;
+            }
+        };
+        using TailList = SingleLinkedList<int, CountingAllocator<int>, TailTracking>;
+        const auto last_value = [](const TailList& list) {
+            return *std::next(list.begin(), static_cast<std::ptrdiff_t>(list.size() - 1));
+        };
+
+        int live_nodes = 0;
+        {
+            TailList list({ 5, 9, 1, 7, 3, 8, 2, 6, 4, 0 }, CountingAllocator<int>(&live_nodes));
+            int calls_left = 7;
+            try
+            {
+                list.sort(ThrowingLess{ &calls_left });
+                assert(false);
+            }
+            catch (const std::runtime_error&)
+            {
+            }
+            assert(static_cast<size_t>(std::distance(list.begin(), list.end())) == list.size() && list.size() == 10u);
+            assert(list.back() == last_value(list));
+            std::vector<int> values(list.begin(), list.end());
+            std::sort(values.begin(), values.end());
+            assert((values == std::vector<int>{ 0, 1, 2, 3, 4, 5, 6, 7, 8, 9 }));
+            list.sort();
+            assert((std::is_sorted(list.begin(), list.end()) && list.back() == 9));
+        }
+        assert(live_nodes == 0);
+
+        {
+            TailList left({ 1, 3, 5, 7 }, CountingAllocator<int>(&live_nodes));
+            TailList right({ 0, 2, 4, 6 }, CountingAllocator<int>(&live_nodes));
+            int calls_left = 3;
+            try
+            {
+                left.merge(right, ThrowingLess{ &calls_left });
+                assert(false);
+            }
+            catch (const std::runtime_error&)
+            {
+            }
+            assert(static_cast<size_t>(std::distance(left.begin(), left.end())) == left.size() && left.size() == 8u);
+            assert(left.back() == last_value(left));
+            assert(right.empty() && right.begin() == right.end());
+            right.push_back(10);
+            assert(right.size() == 1u && right.back() == 10);
+        }
+        assert(live_nodes == 0);
+    }
+}
+
+void Test9()
+{
+    {
+        ConcurrentStack<std::string> stack;
+        assert(stack.empty());
+        assert(!stack.try_pop_front().has_value());
+
+        stack.push_front("one"s);
+        stack.emplace_front(3, 'x');
+        assert(!stack.empty());
+        assert(stack.try_pop_front() == "xxx"s);
+
+        const std::vector<std::string> batch{ "a"s, "b"s, "c"s };
+        stack.push_range(batch.begin(), batch.end());
+        assert(stack.try_pop_front() == "a"s);
+
+        std::vector<std::string> drained;
+        assert(stack.pop_all([&drained](std::string&& value) { drained.push_back(std::move(value)); }) == 3u);
+        assert((drained == std::vector<std::string>{ "b"s, "c"s, "one"s }));
+        assert(stack.empty());
+
+        stack.push_range(batch.begin(), batch.end());
+        const SingleLinkedList<std::string> as_list = stack.pop_all();
+        assert(std::equal(as_list.begin(), as_list.end(), batch.begin(), batch.end()));
+    }
+
+    {
+        // The list from pop_all allocates through the stack's allocator.
+        int live = 0;
+        ConcurrentStack<int, CountingAllocator<int>> stack(ConcurrentStack<int, CountingAllocator<int>>::default_max_threads(), CountingAllocator<int>(&live));
+        for (int value : { 3, 2, 1 })
+        {
+            stack.push_front(value);
+        }
+        int live_with_list = 0;
+        {
+            const SingleLinkedList<int, CountingAllocator<int>> as_list = stack.pop_all();
+            assert((as_list == SingleLinkedList<int, CountingAllocator<int>>{ 1, 2, 3 }));
+            assert(as_list.get_allocator() == CountingAllocator<int>(&live));
+            live_with_list = live;
+        }
+        assert(live == live_with_list - 3);
+    }
+
+    struct ThrowOnCopy
+    {
+        ThrowOnCopy() = default;
+        explicit ThrowOnCopy(int& copy_counter) noexcept : countdown_ptr(&copy_counter) {}
+
+        ThrowOnCopy(const ThrowOnCopy& other) : countdown_ptr(other.countdown_ptr)
+        {
+            if (countdown_ptr)
+            {
+                if (*countdown_ptr == 0)
+                {
+                    throw std::bad_alloc();
+                }
+                else
+                {
+                    --(*countdown_ptr);
+                }
+            }
+        }
+
+        ThrowOnCopy& operator=(const ThrowOnCopy& rhs) = delete;
+        int* countdown_ptr = nullptr;
+    };
+
+    {
+        ConcurrentStack<ThrowOnCopy> stack;
+        std::vector<ThrowOnCopy> batch(4);
+        int copy_counter = 2;
+        for (auto& item : batch)
+        {
+            item.countdown_ptr = &copy_counter;
+        }
+        try
+        {
+            stack.push_range(batch.begin(), batch.end());
+            assert(false);
+        }
+        catch (const std::bad_alloc&)
+        {
+            assert(stack.empty());
+        }
+    }
+
+    {
+        constexpr int kThreads = 4;
+        constexpr int kItemsPerThread = 20000;
+
+        ConcurrentStack<int> stack(kThreads);
+        std::atomic<long long> popped_sum{ 0 };
+        std::atomic<int> popped_count{ 0 };
+
+        std::vector<std::thread> workers;
+        for (int t = 0; t < kThreads; ++t)
+        {
+            workers.emplace_back([&, t]() {
+                for (int i = 0; i < kItemsPerThread; ++i)
+                {
+                    const int value = t * kItemsPerThread + i;
+                    if (i % 3 == 0)
+                    {
+                        const int pair[] = { value, -value };
+                        stack.push_range(std::begin(pair), std::end(pair));
+                    }
+                    else
+                    {
+                        stack.push_front(value);
+                    }
+                    if (const auto popped = stack.try_pop_front())
+                    {
+                        popped_sum += *popped;
+                        ++popped_count;
+                    }
+                }
+            });
+        }
+        for (auto& worker : workers)
+        {
+            worker.join();
+        }
+
+        stack.pop_all([&](int value) {
+            popped_sum += value;
+            ++popped_count;
+        });
+
+        long long expected_sum = 0;
+        int expected_count = 0;
+        for (int t = 0; t < kThreads; ++t)
+        {
+            for (int i = 0; i < kItemsPerThread; ++i)
+            {
+                const int value = t * kItemsPerThread + i;
+                expected_sum += value;
+                expected_count += 1;
+                if (i % 3 == 0)
+                {
+                    expected_sum -= value;
+                    expected_count += 1;
+                }
+            }
+        }
+        assert(popped_sum == expected_sum);
+        assert(popped_count == expected_count);
+        assert(stack.empty());
+    }
+}
+
+void Test10()
+{
+    {
+        SingleLinkedList<int> list;
+        for (int i = 100; i > 0; --i)
+        {
+            list.push_front(i);
+        }
+        const auto& const_list = list;
+
+        for (size_t distance : { size_t{ 0 }, size_t{ 1 }, size_t{ 8 }, size_t{ 1000 } })
+        {
+            assert(const_list.accumulate(0, std::plus<>{}, distance) == 5050);
+            assert(const_list.reduce(0LL, std::plus<>{}, distance) == 5050);
+            assert(const_list.count_if([](int value) { return value % 10 == 0; }, distance) == 10u);
+
+            const auto found = list.find_if([](int value) { return value > 41; }, distance);
+            assert(found != list.end() && *found == 42);
+            assert(const_list.find_if([](int value) { return value > 100; }, distance) == const_list.end());
+
+            int visited = 0;
+            const_list.for_each([&visited](int value) { visited += value; }, distance);
+            assert(visited == 5050);
+        }
+
+        list.for_each([](int& value) { value *= 2; });
+        assert(list.accumulate(0) == 10100);
+        assert(list.begin() == list.find_if([](int) { return true; }));
+
+        const auto counter = list.for_each([count = 0](int) mutable { return ++count; });
+        (void)counter;
+    }
+
+    {
+        const SingleLinkedList<std::string> empty_list;
+        assert(empty_list.accumulate(std::string{}) == ""s);
+        assert(empty_list.count_if([](const std::string&) { return true; }) == 0u);
+        assert(empty_list.find_if([](const std::string&) { return true; }) == empty_list.end());
+
+        const SingleLinkedList<std::string> words{ "a"s, "b"s, "c"s };
+        assert(words.accumulate(std::string{}) == "abc"s);
+    }
+}
+
+void Test11()
+{
+    {
+        SingleLinkedList<int> empty_list;
+        empty_list.defragment();
+        assert(empty_list.empty());
+        assert(empty_list.fragmentation() == 0.0);
+    }
+
+    {
+        using PoolList = SingleLinkedList<std::string, PoolAllocator<std::string>>;
+        PoolList list;
+        std::vector<std::string> expected;
+        for (int i = 0; i < 500; ++i)
+        {
+            list.push_front(std::to_string(i));
+            expected.insert(expected.begin(), std::to_string(i));
+        }
+
+        // Interleave erasures and insertions so that list order stops following address order.
+        unsigned state = 99;
+        for (int round = 0; round < 2000; ++round)
+        {
+            state = state * 1103515245u + 12345u;
+            const size_t pos = (state >> 16) % expected.size();
+            auto it = list.cbefore_begin();
+            for (size_t i = 0; i < pos; ++i)
+            {
+                ++it;
+            }
+            list.erase(it);
+            expected.erase(expected.begin() + pos);
+
+            state = state * 1103515245u + 12345u;
+            const size_t insert_pos = (state >> 16) % (expected.size() + 1);
+            it = list.cbefore_begin();
+            for (size_t i = 0; i < insert_pos; ++i)
+            {
+                ++it;
+            }
+            list.insert(it, std::to_string(round));
+            expected.insert(expected.begin() + insert_pos, std::to_string(round));
+        }
+        assert(list.fragmentation() > 0.5);
+        assert(list.fragmentation(10) >= 0.0 && list.fragmentation(10) <= 1.0);
+
+        list.defragment();
+        assert(list.size() == expected.size());
+        assert(std::equal(list.begin(), list.end(), expected.begin(), expected.end()));
+
+        const std::string* previous = nullptr;
+        for (const std::string& value : list)
+        {
+            assert(previous == nullptr || previous < &value);
+            previous = &value;
+        }
+    }
+
+    struct ThrowOnCopy
+    {
+        ThrowOnCopy() = default;
+        explicit ThrowOnCopy(int& copy_counter) noexcept : countdown_ptr(&copy_counter) {}
+
+        ThrowOnCopy(const ThrowOnCopy& other) : countdown_ptr(other.countdown_ptr)
+        {
+            if (countdown_ptr)
+            {
+                if (*countdown_ptr == 0)
+                {
+                    throw std::bad_alloc();
+                }
+                else
+                {
+                    --(*countdown_ptr);
+                }
+            }
+        }
+
+        ThrowOnCopy& operator=(const ThrowOnCopy& rhs) = delete;
+        int* countdown_ptr = nullptr;
+    };
+
+    {
+        SingleLinkedList<ThrowOnCopy> list{ ThrowOnCopy{}, ThrowOnCopy{}, ThrowOnCopy{} };
+        int copy_counter = 1;
+        for (auto& item : list)
+        {
+            item.countdown_ptr = &copy_counter;
+        }
+        const auto old_begin = list.begin();
+
+        try
+        {
+            list.defragment();
+            assert(false);
+        }
+        catch (const std::bad_alloc&)
+        {
+            assert(list.size() == 3u);
+            assert(list.begin() == old_begin);
+            for (const auto& item : list)
+            {
+                assert(item.countdown_ptr == &copy_counter);
+            }
+        }
+    }
+}
+
+struct IntrusiveItem : IntrusiveListHook
+{
+    explicit IntrusiveItem(int id) : id(id) {}
+
+    int id = 0;
+};
+
+struct SafeIntrusiveItem : SafeIntrusiveListHook
+{
+    explicit SafeIntrusiveItem(int id) : id(id) {}
+
+    int id = 0;
+};
+
+struct MemberHookedItem
+{
+    explicit MemberHookedItem(std::string name) : name(std::move(name)) {}
+
+    std::string name;
+    SafeIntrusiveListHook by_name;
+    IntrusiveListHook by_age;
+};
+
+void Test12()
+{
+    {
+        IntrusiveItem first(1);
+        IntrusiveItem second(2);
+        IntrusiveItem third(3);
+
+        IntrusiveList<IntrusiveItem> list;
+        assert(list.empty());
+        assert(++list.before_begin() == list.begin());
+
+        list.push_front(third);
+        list.push_front(first);
+        const auto inserted = list.insert(list.cbegin(), second);
+        assert(&*inserted == &second);
+        assert(list.size() == 3u);
+        assert(&*list.begin() == &first);
+
+        int expected_id = 1;
+        for (const IntrusiveItem& item : list)
+        {
+            assert(item.id == expected_id++);
+        }
+
+        const auto after_erased = list.erase(list.cbegin());
+        assert(&*after_erased == &third);
+        list.pop_front();
+        assert(list.size() == 1u && &*list.begin() == &third);
+        assert(list.iterator_to(third) == list.begin());
+
+        const IntrusiveItem copy(third);
+        assert(copy.next_hook == nullptr);
+
+        IntrusiveList<IntrusiveItem> moved(std::move(list));
+        assert(list.empty());
+        assert(moved.size() == 1u && &*moved.begin() == &third);
+        moved.clear();
+        assert(moved.empty());
+    }
+
+    {
+        SafeIntrusiveItem a(1);
+        SafeIntrusiveItem b(2);
+        SafeIntrusiveItem c(3);
+        {
+            IntrusiveList<SafeIntrusiveItem> list;
+            list.push_front(c);
+            list.push_front(b);
+            list.push_front(a);
+            assert(a.is_linked() && b.is_linked() && c.is_linked());
+
+            list.erase(b);
+            assert(!b.is_linked());
+            assert(list.size() == 2u);
+            assert(&*list.begin() == &a && &*(++list.begin()) == &c);
+
+            list.erase(a);
+            assert(&*list.begin() == &c);
+            list.push_front(b);
+            list.erase(c);
+            assert(list.size() == 1u && &*list.begin() == &b);
+
+            IntrusiveList<SafeIntrusiveItem> other;
+            other.push_front(a);
+            other.swap(list);
+            assert(&*list.begin() == &a && &*other.begin() == &b);
+            other.erase(b);
+            list.erase(a);
+            assert(list.empty() && other.empty());
+
+            list.push_front(a);
+            list.push_front(c);
+            IntrusiveList<SafeIntrusiveItem> moved;
+            moved = std::move(list);
+            moved.erase(c);
+            assert(&*moved.begin() == &a);
+        }
+        assert(!a.is_linked() && !b.is_linked() && !c.is_linked());
+    }
+
+    {
+        using ByName = IntrusiveList<MemberHookedItem, MemberHook<MemberHookedItem, SafeIntrusiveListHook, &MemberHookedItem::by_name, offsetof(MemberHookedItem, by_name)>>;
+        using ByAge = IntrusiveList<MemberHookedItem, MemberHook<MemberHookedItem, IntrusiveListHook, &MemberHookedItem::by_age, offsetof(MemberHookedItem, by_age)>>;
+
+        MemberHookedItem anna("anna"s);
+        MemberHookedItem boris("boris"s);
+        {
+            ByName by_name;
+            ByAge by_age;
+            by_name.push_front(boris);
+            by_name.push_front(anna);
+            by_age.push_front(anna);
+            by_age.push_front(boris);
+
+            assert(by_name.begin()->name == "anna"s);
+            assert(by_age.begin()->name == "boris"s);
+
+            by_name.erase(anna);
+            assert(by_name.begin()->name == "boris"s);
+            assert(by_age.size() == 2u);
+        }
+    }
+}
+
+void Test13()
+{
+    using IntPersistentList = PersistentList<int>;
+
+    {
+        const IntPersistentList empty_list;
+        assert(empty_list.empty());
+        assert(empty_list.begin() == empty_list.end());
+
+        IntPersistentList original{ 1, 2, 3 };
+        assert(original.size() == 3u);
+        assert(original.front() == 1);
+
+        IntPersistentList snapshot(original);
+        assert(snapshot.shares_with(original));
+        assert(snapshot == original);
+
+        snapshot.push_front(0);
+        assert(snapshot.size() == 4u);
+        assert(original.size() == 3u);
+        assert(&*(++snapshot.begin()) == &*original.begin());
+        assert((std::equal(snapshot.begin(), snapshot.end(), std::begin({ 0, 1, 2, 3 }))));
+        assert((std::equal(original.begin(), original.end(), std::begin({ 1, 2, 3 }))));
+
+        original.pop_front();
+        assert(original.front() == 2);
+        assert((std::equal(snapshot.begin(), snapshot.end(), std::begin({ 0, 1, 2, 3 }))));
+
+        IntPersistentList assigned;
+        assigned = snapshot;
+        assert(assigned.shares_with(snapshot));
+        snapshot.clear();
+        assert(snapshot.empty());
+        assert(assigned.size() == 4u && assigned.front() == 0);
+
+        IntPersistentList moved(std::move(assigned));
+        assert(assigned.empty());
+        assert(moved.size() == 4u);
+
+        assert((IntPersistentList{ 1, 2 } < IntPersistentList{ 1, 3 }));
+        assert((IntPersistentList{ 1, 2 } != IntPersistentList{ 1, 3 }));
+        assert((IntPersistentList{ 1, 2 } == IntPersistentList{ 1, 2 }));
+    }
+
+    {
+        const SingleLinkedList<std::string> source{ "a"s, "b"s, "c"s };
+        const PersistentList<std::string> persistent(source);
+        assert(std::equal(persistent.begin(), persistent.end(), source.begin(), source.end()));
+
+        const SingleLinkedList<std::string> round_trip = persistent.to_list();
+        assert(round_trip.size() == 3u);
+        assert(std::equal(round_trip.begin(), round_trip.end(), source.begin(), source.end()));
+    }
+
+    {
+        int live_nodes = 0;
+        {
+            using CountedList = PersistentList<int, CountingAllocator<int>>;
+            CountedList base{ { 1, 2, 3 }, CountingAllocator<int>(&live_nodes) };
+            CountedList branch(base);
+            branch.push_front(10);
+            assert(live_nodes == 4);
+
+            base.pop_front();
+            base.pop_front();
+            assert(live_nodes == 4);
+
+            branch.clear();
+            assert(live_nodes == 1);
+        }
+        assert(live_nodes == 0);
+    }
+
+    {
+        // A long unshared chain must be released without recursion.
+        IntPersistentList long_list;
+        for (int i = 0; i < 1'000'000; ++i)
+        {
+            long_list.push_front(i);
+        }
+        IntPersistentList tail(long_list);
+        tail.pop_front();
+        long_list.clear();
+        assert(tail.size() == 999'999u);
+        tail.clear();
+    }
+}
+
+void Test14()
+{
+    using Queue = SingleLinkedList<int, std::allocator<int>, TailTracking>;
+    const auto holds = [](const Queue& queue, std::initializer_list<int> expected) {
+        return queue.size() == expected.size() && std::equal(queue.begin(), queue.end(), expected.begin(), expected.end())
+            && (queue.empty() ? queue.before_end() == queue.before_begin() : &queue.back() == &*std::next(queue.before_begin(), queue.size()));
+    };
+
+    static_assert(sizeof(SingleLinkedList<int>) < sizeof(Queue), "only tail-tracking lists pay for the tail");
+
+    {
+        Queue queue;
+        assert(holds(queue, {}));
+        queue.push_back(1);
+        queue.emplace_back(2);
+        queue.push_front(0);
+        assert(holds(queue, { 0, 1, 2 }));
+        assert(queue.back() == 2);
+
+        queue.insert(queue.before_end(), 3);
+        assert(holds(queue, { 0, 1, 2, 3 }));
+        queue.insert(queue.cbefore_begin(), -1);
+        assert(holds(queue, { -1, 0, 1, 2, 3 }));
+
+        queue.erase(std::next(queue.cbefore_begin(), 3));
+        assert(holds(queue, { -1, 0, 1, 3 }));
+        queue.erase(std::next(queue.cbefore_begin(), 3));
+        assert(holds(queue, { -1, 0, 1 }));
+
+        queue.pop_front();
+        queue.pop_front();
+        assert(holds(queue, { 1 }));
+        queue.pop_front();
+        assert(holds(queue, {}));
+        queue.push_back(7);
+        assert(holds(queue, { 7 }));
+        queue.clear();
+        assert(holds(queue, {}));
+        queue.push_back(8);
+        assert(holds(queue, { 8 }));
+    }
+
+    {
+        Queue first{ 1, 2 };
+        Queue second{ 3, 4, 5 };
+        first.append(std::move(second));
+        assert(holds(first, { 1, 2, 3, 4, 5 }));
+        assert(holds(second, {}));
+        first.append(Queue{});
+        assert(holds(first, { 1, 2, 3, 4, 5 }));
+        second.append(std::move(first));
+        assert(holds(second, { 1, 2, 3, 4, 5 }));
+        second.push_back(6);
+        assert(holds(second, { 1, 2, 3, 4, 5, 6 }));
+
+        Queue other{ 9 };
+        other.swap(second);
+        assert(holds(other, { 1, 2, 3, 4, 5, 6 }));
+        assert(holds(second, { 9 }));
+        second.push_back(10);
+        other.push_back(7);
+        assert(holds(second, { 9, 10 }));
+        assert(holds(other, { 1, 2, 3, 4, 5, 6, 7 }));
+
+        Queue copy(other);
+        copy.push_back(8);
+        assert(holds(copy, { 1, 2, 3, 4, 5, 6, 7, 8 }));
+        Queue moved(std::move(copy));
+        assert(holds(moved, { 1, 2, 3, 4, 5, 6, 7, 8 }));
+        assert(holds(copy, {}));
+        copy = moved;
+        moved = Queue{ 4 };
+        assert(holds(copy, { 1, 2, 3, 4, 5, 6, 7, 8 }));
+        assert(holds(moved, { 4 }));
+    }
+
+    {
+        // Splicing, merging and sorting all relink the last node.
+        Queue left{ 1, 2, 3 };
+        Queue right{ 4, 5, 6 };
+        left.splice_after(left.cbefore_begin(), right, right.cbefore_begin(), std::next(right.cbegin(), 2));
+        assert(holds(left, { 4, 5, 1, 2, 3 }));
+        assert(holds(right, { 6 }));
+        left.splice_after(left.before_end(), right, right.cbefore_begin());
+        assert(holds(left, { 4, 5, 1, 2, 3, 6 }));
+        assert(holds(right, {}));
+        right.splice_after(right.cbefore_begin(), left, std::next(left.cbefore_begin(), 4), left.cend());
+        assert(holds(left, { 4, 5, 1, 2 }));
+        assert(holds(right, { 3, 6 }));
+        left.splice_after(left.before_end(), right);
+        assert(holds(left, { 4, 5, 1, 2, 3, 6 }));
+        left.splice_after(std::next(left.cbegin(), 2), left, std::next(left.cbegin(), 4));
+        assert(holds(left, { 4, 5, 1, 6, 2, 3 }));
+
+        left.sort();
+        assert(holds(left, { 1, 2, 3, 4, 5, 6 }));
+        left.sort(std::greater<>{});
+        assert(holds(left, { 6, 5, 4, 3, 2, 1 }));
+
+        Queue evens{ 0, 2, 8 };
+        Queue odds{ 1, 3 };
+        evens.merge(odds);
+        assert(holds(evens, { 0, 1, 2, 3, 8 }));
+        assert(holds(odds, {}));
+        odds.merge(evens);
+        assert(holds(odds, { 0, 1, 2, 3, 8 }));
+
+        odds.defragment();
+        assert(holds(odds, { 0, 1, 2, 3, 8 }));
+        odds.push_back(9);
+        assert(holds(odds, { 0, 1, 2, 3, 8, 9 }));
+    }
+
+    {
+        // The untracked list keeps O(n) splicing of whole lists.
+        SingleLinkedList<int> lean{ 1, 2 };
+        SingleLinkedList<int> other{ 3, 4 };
+        lean.splice_after(std::next(lean.cbegin()), other);
+        assert(std::equal(lean.begin(), lean.end(), std::begin({ 1, 2, 3, 4 })));
+        assert(other.empty());
+    }
+}
+
+void Test15()
+{
+    {
+        WorkStealingThreadPool pool(3);
+        assert(pool.worker_count() == 3u);
+        assert(pool.concurrency() == 4u);
+
+        std::atomic<int> sum{ 0 };
+        {
+            TaskGroup group(pool);
+            for (int i = 1; i <= 100; ++i)
+            {
+                group.run([&sum, &pool, i]() {
+                    // Nested groups wait by running other tasks, so they cannot deadlock the pool.
+                    TaskGroup nested(pool);
+                    nested.run([&sum, i]() {
+                        sum += i;
+                    });
+                    nested.wait();
+                });
+            }
+            group.wait();
+        }
+        assert(sum == 5050);
+
+        TaskGroup failing(pool);
+        failing.run([]() {
+            throw std::runtime_error("segment failed");
+        });
+        bool thrown = false;
+        try
+        {
+            failing.wait();
+        }
+        catch (const std::runtime_error&)
+        {
+            thrown = true;
+        }
+        assert(thrown);
+    }
+
+    {
+        WorkStealingThreadPool pool(3);
+        const ParallelPolicy policy{ &pool, 0, 100 };
+
+        SingleLinkedList<long long> list;
+        for (long long i = 100'000; i > 0; --i)
+        {
+            list.push_front(i);
+        }
+        const long long expected_sum = 100'000LL * 100'001 / 2;
+
+        assert(list.reduce(policy, 0LL) == expected_sum);
+        assert(list.reduce(kSequenced, 0LL) == expected_sum);
+        assert(list.reduce(policy, 1LL, [](long long lhs, long long rhs) { return std::max(lhs, rhs); }) == 100'000);
+        assert(list.count_if(policy, [](long long value) { return value % 3 == 0; }) == 33'333u);
+
+        list.transform_inplace(policy, [](long long value) { return value * 2; });
+        assert(list.reduce(policy, 0LL) == expected_sum * 2);
+        list.for_each(policy, [](long long& value) { value -= 1; });
+        assert(*list.begin() == 1);
+        assert(list.reduce(kSequenced, 0LL) == expected_sum * 2 - 100'000);
+
+        // Every element is visited exactly once, whatever the segment count.
+        for (const size_t segments : { 1, 2, 7, 64, 100'000, 300'000 })
+        {
+            std::atomic<size_t> visits{ 0 };
+            static_cast<const SingleLinkedList<long long>&>(list).for_each(ParallelPolicy{ &pool, segments, 1 }, [&visits](const long long&) {
+                ++visits;
+            });
+            assert(visits == list.size());
+            assert(list.count_if(ParallelPolicy{ &pool, segments, 1 }, [](long long) { return true; }) == list.size());
+        }
+
+        bool thrown = false;
+        try
+        {
+            list.for_each(policy, [](long long value) {
+                if (value == 99'999)
+                {
+                    throw std::runtime_error("bad value");
+                }
+            });
+        }
+        catch (const std::runtime_error&)
+        {
+            thrown = true;
+        }
+        assert(thrown);
+
+        const SingleLinkedList<long long> empty_list;
+        assert(empty_list.reduce(policy, 5LL) == 5);
+        assert(empty_list.count_if(policy, [](long long) { return true; }) == 0u);
+
+        SingleLinkedList<std::string> words{ "a"s, "b"s, "c"s };
+        words.transform_inplace(kParallel, [](std::string word) { return word + word; });
+        assert(words.reduce(kParallel, ""s).size() == 6u);
+        words.transform_inplace([](std::string word) { return word.substr(1); });
+        assert((std::equal(words.begin(), words.end(), std::begin({ "a"s, "b"s, "c"s }))));
+    }
+}
+
+void Test16()
+{
+    struct Tracked
+    {
+        Tracked() = default;
+        explicit Tracked(int v) : value(v) {}
+
+        int value = 0;
+    };
+    using StatsList = SingleLinkedList<Tracked, std::allocator<Tracked>, NoTailTracking, ListStats>;
+
+    static_assert(sizeof(SingleLinkedList<int>) == sizeof(SingleLinkedList<int, std::allocator<int>, NoTailTracking, NoListStats>));
+    static_assert(sizeof(SingleLinkedList<int>) < sizeof(SingleLinkedList<int, std::allocator<int>, NoTailTracking, ListStats>));
+
+    assert(ListStatistics::distance_bucket(0) == 0u);
+    assert(ListStatistics::distance_bucket(1) == 1u);
+    assert(ListStatistics::distance_bucket(3) == 2u);
+    assert(ListStatistics::distance_bucket(4) == 3u);
+    assert(ListStatistics::distance_bucket(63) == 6u);
+    assert(ListStatistics::distance_bucket(64) == 7u);
+    assert(ListStatistics::distance_bucket(100'000) == 7u);
+
+    {
+        const SingleLinkedList<int> plain{ 1, 2, 3 };
+        assert(plain.memory_footprint() > sizeof(plain) + 3 * sizeof(int));
+    }
+
+    const ListStatistics before = StatsList::type_stats();
+    {
+        StatsList list;
+        const Tracked value(1);
+        list.push_front(value);
+        list.push_front(Tracked(2));
+        list.emplace_front(3);
+        assert(list.stats().allocations == 3u);
+        assert(list.stats().copies == 1u);
+        assert(list.stats().moves == 1u);
+        assert(list.stats().insert_distances[0] == 3u);
+
+        list.insert(std::next(list.cbegin()), value);
+        assert(list.stats().insert_distances[ListStatistics::distance_bucket(2)] == 1u);
+        list.erase(list.cbegin());
+        assert(list.stats().erase_distances[1] == 1u);
+        list.pop_front();
+        assert(list.stats().erase_distances[0] == 1u);
+        assert(list.stats().deallocations == 2u);
+        assert(list.stats().peak_size == 4u);
+        assert(list.size() == 2u);
+        assert(list.memory_footprint() > sizeof(StatsList) + 2 * sizeof(Tracked));
+
+        auto last = list.before_begin();
+        while (std::next(last) != list.end())
+        {
+            ++last;
+        }
+        for (int i = 0; i < 100; ++i)
+        {
+            last = list.insert(last, Tracked(i));
+        }
+        assert(list.stats().insert_distances[ListStatistics::kDistanceBuckets - 1] > 0u);
+        assert(list.stats().peak_size == 102u);
+
+        // Assignment frees the old nodes through a temporary; the list still accounts for them.
+        StatsList other;
+        other.emplace_front(7);
+        list = other;
+        assert(list.size() == 1u);
+        assert(list.stats().allocations == 105u);
+        assert(list.stats().deallocations == 104u);
+        assert(list.stats().copies == 3u);
+        assert(list.stats().moves == 101u);
+
+        list.defragment();
+        assert(list.stats().allocations == 106u);
+        assert(list.stats().deallocations == 105u);
+        assert(list.stats().moves == 102u);
+
+        std::ostringstream dump;
+        list.dump_stats(dump);
+        assert(dump.str().find("allocations: 106\n") != std::string::npos);
+        assert(dump.str().find("peak_size: 102\n") != std::string::npos);
+        assert(dump.str().find("insert_distances: [0,1)=") != std::string::npos);
+
+        std::ostringstream type_dump;
+        StatsList::dump_type_stats(type_dump);
+        assert(type_dump.str().find("size: 2\n") != std::string::npos);
+    }
+    const ListStatistics after = StatsList::type_stats();
+    assert(after.allocations - before.allocations == 107u);
+    assert(after.deallocations - before.deallocations == 107u);
+}
+
+void Test17()
+{
+    using SmallList = SingleLinkedList<std::string, CountingAllocator<std::string>, NoTailTracking, NoListStats, InlineNodes<4>>;
+    using SmallQueue = SingleLinkedList<std::string, CountingAllocator<std::string>, TailTracking, NoListStats, InlineNodes<2>>;
+    const auto holds = [](const auto& list, std::initializer_list<std::string> expected) {
+        return list.size() == expected.size() && std::equal(list.begin(), list.end(), expected.begin(), expected.end());
+    };
+
+    int live_nodes = 0;
+    {
+        const CountingAllocator<std::string> alloc(&live_nodes);
+
+        SmallList list(alloc);
+        list.push_front("d"s);
+        list.push_front("c"s);
+        list.push_front("b"s);
+        list.push_front("a"s);
+        assert(live_nodes == 0);
+        assert(list.memory_footprint() == sizeof(SmallList));
+
+        list.insert(list.cbefore_begin(), "0"s);
+        assert(live_nodes == 1);
+        assert(holds(list, { "0", "a", "b", "c", "d" }));
+
+        // Freed inline slots are reused before the allocator.
+        list.erase(std::next(list.cbegin()));
+        list.pop_front();
+        assert(live_nodes == 0);
+        list.push_front("x"s);
+        assert(live_nodes == 0);
+        list.push_front("y"s);
+        assert(live_nodes == 1);
+        list.erase(std::next(list.cbegin()));
+        list.push_front("w"s);
+        assert(live_nodes == 1);
+        assert(holds(list, { "w", "y", "x", "c", "d" }));
+
+        list.clear();
+        assert(live_nodes == 0);
+        list = SmallList{ { "1"s, "2"s, "3"s }, alloc };
+        assert(live_nodes == 0);
+        assert(holds(list, { "1", "2", "3" }));
+
+        SmallList copy(list);
+        assert(live_nodes == 0);
+        assert(copy == list);
+
+        // Moving relocates inline nodes instead of pointing into the source object.
+        SmallList moved(std::move(copy));
+        assert(copy.empty());
+        copy.push_front("z"s);
+        assert(holds(moved, { "1", "2", "3" }));
+        assert(holds(copy, { "z" }));
+
+        {
+            SmallList big({ "a"s, "b"s, "c"s, "d"s, "e"s, "f"s }, alloc);
+            assert(live_nodes == 2);
+            big.swap(moved);
+            assert(holds(big, { "1", "2", "3" }));
+            assert(holds(moved, { "a", "b", "c", "d", "e", "f" }));
+            big.push_front("0"s);
+            moved.pop_front();
+            assert(holds(big, { "0", "1", "2", "3" }));
+
+            moved = std::move(big);
+            assert(holds(moved, { "0", "1", "2", "3" }));
+            big.push_front("fresh"s);
+            assert(holds(big, { "fresh" }));
+        }
+        assert(holds(moved, { "0", "1", "2", "3" }));
+        assert(holds(copy, { "z" }));
+
+        // Spliced and merged nodes must not stay in the storage of the list they came from.
+        {
+            SmallList donor({ "p"s, "q"s, "r"s, "s"s }, alloc);
+            copy.splice_after(copy.cbegin(), donor, donor.cbegin());
+            copy.splice_after(copy.cbefore_begin(), donor, donor.cbefore_begin(), std::next(donor.cbegin(), 2));
+            assert(holds(copy, { "p", "r", "z", "q" }));
+            assert(holds(donor, { "s" }));
+            moved.splice_after(moved.cbefore_begin(), donor);
+            assert(donor.empty());
+        }
+        assert(holds(copy, { "p", "r", "z", "q" }));
+        assert(holds(moved, { "s", "0", "1", "2", "3" }));
+
+        {
+            SmallList left({ "a"s, "c"s }, alloc);
+            {
+                SmallList right({ "b"s, "d"s }, alloc);
+                left.merge(right);
+            }
+            assert(holds(left, { "a", "b", "c", "d" }));
+            left.sort(std::greater<>{});
+            assert(holds(left, { "d", "c", "b", "a" }));
+        }
+
+        {
+            SmallQueue queue(alloc);
+            queue.push_back("1"s);
+            queue.push_back("2"s);
+            {
+                SmallQueue other(alloc);
+                other.push_back("3"s);
+                other.push_back("4"s);
+                queue.append(std::move(other));
+            }
+            queue.push_back("5"s);
+            assert(holds(queue, { "1", "2", "3", "4", "5" }));
+            assert(queue.back() == "5"s);
+
+            SmallQueue swapped(alloc);
+            swapped.push_back("x"s);
+            swapped.swap(queue);
+            queue.push_back("y"s);
+            swapped.push_back("6"s);
+            assert(holds(queue, { "x", "y" }));
+            assert(holds(swapped, { "1", "2", "3", "4", "5", "6" }));
+            assert(swapped.back() == "6"s);
+        }
+    }
+    assert(live_nodes == 0);
+}
+
+struct SerializedRecord
+{
+    std::string name;
+    int id = 0;
+
+    bool operator==(const SerializedRecord& rhs) const
+    {
+        return name == rhs.name && id == rhs.id;
+    }
+};
+
+template <>
+struct ListSerializer<SerializedRecord>
+{
+    static void write(ListWriter& writer, const SerializedRecord& record)
+    {
+        writer.write_value(record.name);
+        writer.write_integer<int32_t>(record.id);
+    }
+
+    static SerializedRecord read(ListReader& reader)
+    {
+        SerializedRecord record;
+        record.name = reader.read_value<std::string>();
+        record.id = reader.read_integer<int32_t>();
+        return record;
+    }
+};
+
+void Test18()
+{
+    const auto round_trip = [](const auto& source, auto& target, size_t chunk_bytes) {
+        std::stringstream stream;
+        source.serialize(stream, chunk_bytes);
+        target.deserialize(stream);
+        return std::equal(source.begin(), source.end(), target.begin(), target.end());
+    };
+    const auto expect_format_error = [](auto& target, const std::string& bytes) {
+        const std::vector<int> before(target.begin(), target.end());
+        std::stringstream stream(bytes);
+        bool thrown = false;
+        try
+        {
+            target.deserialize(stream);
+        }
+        catch (const ListFormatError&)
+        {
+            thrown = true;
+        }
+        return thrown && std::equal(before.begin(), before.end(), target.begin(), target.end());
+    };
+
+    static_assert(kRawListSerializer<int> && kRawListSerializer<std::array<double, 4>>);
+    static_assert(!kRawListSerializer<std::string> && !kRawListSerializer<SerializedRecord>);
+
+    {
+        SingleLinkedList<int> source;
+        for (int i = 0; i < 5000; ++i)
+        {
+            source.push_front(i * 7);
+        }
+        SingleLinkedList<int> target{ 1, 2, 3 };
+        assert(round_trip(source, target, list_format::kDefaultChunkBytes));
+        // Chunks of 3 bytes split every value across chunk boundaries.
+        assert(round_trip(source, target, 3));
+
+        SingleLinkedList<int> empty_source;
+        assert(round_trip(empty_source, target, 16));
+        assert(target.empty());
+
+        std::stringstream stream;
+        source.serialize(stream, 1024);
+        const std::string bytes = stream.str();
+        target = SingleLinkedList<int>{ 9, 8 };
+
+        std::string damaged = bytes;
+        damaged[bytes.size() / 2] ^= 0x10;
+        assert(expect_format_error(target, damaged));
+        assert(expect_format_error(target, bytes.substr(0, bytes.size() - 5)));
+        assert(expect_format_error(target, "not a list"s));
+
+        std::string future_version = bytes;
+        future_version[4] = 2;
+        assert(expect_format_error(target, future_version));
+
+        // The header records the element encoding, so a list of another type is rejected.
+        std::stringstream strings;
+        SingleLinkedList<std::string>{ "a"s }.serialize(strings);
+        assert(expect_format_error(target, strings.str()));
+    }
+
+    {
+        SingleLinkedList<std::string> source{ ""s, "short"s, std::string(10'000, 'x') };
+        SingleLinkedList<std::string> target;
+        assert(round_trip(source, target, 7));
+        assert(round_trip(source, target, 1 << 20));
+
+        SingleLinkedList<SerializedRecord> records{ { "anna"s, 1 }, { "boris"s, -2 } };
+        SingleLinkedList<SerializedRecord> loaded;
+        assert(round_trip(records, loaded, 5));
+
+        using Queue = SingleLinkedList<int, std::allocator<int>, TailTracking, NoListStats, InlineNodes<2>>;
+        Queue queue;
+        for (int i = 0; i < 3000; ++i)
+        {
+            queue.push_back(i);
+        }
+        Queue loaded_queue;
+        assert(round_trip(queue, loaded_queue, 100));
+        assert(loaded_queue.back() == 2999);
+        loaded_queue.push_back(3000);
+        assert(loaded_queue.size() == 3001u);
+    }
+}
+
+void Test19()
+{
+    using FingerprintList = SingleLinkedList<int, std::allocator<int>, NoTailTracking, NoListStats, NoInlineNodes, Fingerprint>;
+    // A plain list computes the hash from scratch, which the maintained fingerprint must match.
+    const auto fresh_hash = [](const auto& list) {
+        SingleLinkedList<int> plain;
+        auto last = plain.before_begin();
+        for (int value : list)
+        {
+            last = plain.insert(last, value);
+        }
+        return plain.hash();
+    };
+
+    {
+        assert((SingleLinkedList<int>{ 1, 2, 3 } != SingleLinkedList<int>{ 1, 2, 4 }));
+        assert((SingleLinkedList<int>{ 1, 2, 3 } != SingleLinkedList<int>{ 3, 2, 1 }));
+        assert((SingleLinkedList<int>{ 1, 2 } != SingleLinkedList<int>{ 1, 2, 3 }));
+        assert((SingleLinkedList<int>{ 1, 2, 3 } == SingleLinkedList<int>{ 1, 2, 3 }));
+        assert((SingleLinkedList<int>{ 1, 2, 3 }.hash() != SingleLinkedList<int>{ 3, 2, 1 }.hash()));
+        assert(SingleLinkedList<int>{}.hash() == FingerprintList{}.hash());
+    }
+
+    {
+        FingerprintList list;
+        for (int i = 0; i < 100; ++i)
+        {
+            list.push_front(i);
+            assert(list.hash() == fresh_hash(list));
+        }
+        auto middle = std::next(list.before_begin(), 40);
+        list.insert(middle, -1);
+        assert(list.hash() == fresh_hash(list));
+        list.erase(middle);
+        assert(list.hash() == fresh_hash(list));
+        list.erase(std::next(list.before_begin(), 98));
+        assert(list.hash() == fresh_hash(list));
+        list.pop_front();
+        assert(list.hash() == fresh_hash(list));
+
+        FingerprintList same;
+        for (int value : list)
+        {
+            same.push_front(value);
+        }
+        same.sort(std::greater<>{});
+        assert(same.hash() == fresh_hash(same));
+        list.sort(std::greater<>{});
+        assert(list == same && list.hash() == same.hash());
+        assert(std::hash<FingerprintList>{}(list) == same.hash());
+
+        *same.begin() = 1000;
+        assert(list.size() == same.size() && list.hash() != fresh_hash(same));
+        same.refresh_fingerprint();
+        assert(same.hash() == fresh_hash(same) && list != same);
+        same.transform_inplace([](int value) {
+            return value == 1000 ? 98 : value;
+        });
+        assert(same.hash() == fresh_hash(same) && list == same);
+        list.for_each([](int& value) {
+            value *= 2;
+        });
+        assert(list.hash() == fresh_hash(list) && list != same);
+
+        list.clear();
+        assert(list.hash() == FingerprintList{}.hash());
+        list = same;
+        assert(list.hash() == same.hash() && list == same);
+        list = FingerprintList{ 4, 5 };
+        assert(list.hash() == fresh_hash(list));
+        swap(list, same);
+        assert(list.hash() == fresh_hash(list) && same.hash() == fresh_hash(same));
+        FingerprintList moved(std::move(list));
+        assert(moved.hash() == fresh_hash(moved) && list.hash() == FingerprintList{}.hash());
+    }
+
+    {
+        FingerprintList left{ 1, 2, 3, 4, 5 };
+        FingerprintList right{ 10, 20, 30, 40 };
+        left.splice_after(left.begin(), right, right.begin());
+        assert((left == FingerprintList{ 1, 20, 2, 3, 4, 5 }) && (right == FingerprintList{ 10, 30, 40 }));
+        assert(left.hash() == fresh_hash(left) && right.hash() == fresh_hash(right));
+        left.splice_after(std::next(left.begin(), 4), left, left.before_begin());
+        assert((left == FingerprintList{ 20, 2, 3, 4, 1, 5 }) && left.hash() == fresh_hash(left));
+        left.splice_after(left.before_begin(), right, right.begin(), right.end());
+        assert((left == FingerprintList{ 30, 40, 20, 2, 3, 4, 1, 5 }) && (right == FingerprintList{ 10 }));
+        assert(left.hash() == fresh_hash(left) && right.hash() == fresh_hash(right));
+        left.splice_after(std::next(left.begin(), 3), left, left.before_begin(), std::next(left.begin(), 2));
+        assert((left == FingerprintList{ 20, 2, 30, 40, 3, 4, 1, 5 }) && left.hash() == fresh_hash(left));
+        left.splice_after(left.begin(), right);
+        assert((left == FingerprintList{ 20, 10, 2, 30, 40, 3, 4, 1, 5 }) && right.empty());
+        assert(left.hash() == fresh_hash(left) && right.hash() == fresh_hash(right));
+
+        left.sort();
+        FingerprintList sorted{ 0, 6, 100 };
+        left.merge(sorted);
+        assert((left == FingerprintList{ 0, 1, 2, 3, 4, 5, 6, 10, 20, 30, 40, 100 }));
+        assert(left.hash() == fresh_hash(left) && sorted.hash() == fresh_hash(sorted));
+    }
+
+    {
+        using Queue = SingleLinkedList<std::string, std::allocator<std::string>, TailTracking, NoListStats, InlineNodes<2>, Fingerprint>;
+        const auto fresh = [](const Queue& queue) {
+            SingleLinkedList<std::string> plain;
+            auto last = plain.before_begin();
+            for (const std::string& value : queue)
+            {
+                last = plain.insert(last, value);
+            }
+            return plain.hash();
+        };
+        Queue queue{ "a"s, "b"s };
+        Queue tail{ "c"s, "d"s, "e"s };
+        queue.append(std::move(tail));
+        queue.push_back("f"s);
+        assert(queue.hash() == fresh(queue) && tail.hash() == fresh(tail));
+        Queue copy(queue);
+        assert(copy == queue && copy.hash() == queue.hash());
+        copy.pop_front();
+        copy.push_front("z"s);
+        assert(copy != queue && copy.hash() == fresh(copy));
+
+        std::unordered_set<Queue> seen{ queue, copy };
+        assert(seen.count(Queue{ "a"s, "b"s, "c"s, "d"s, "e"s, "f"s }) == 1);
+        assert(seen.count(Queue{ "a"s, "b"s }) == 0);
+    }
+}
+
+// Counts live instances, which the reclaimer thread destroys concurrently with the test.
+struct LiveCounted
+{
+    static inline std::atomic<int> live{ 0 };
+
+    LiveCounted() noexcept
+    {
+        live.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    LiveCounted(const LiveCounted&) noexcept : LiveCounted() {}
+
+    ~LiveCounted()
+    {
+        live.fetch_sub(1, std::memory_order_relaxed);
+    }
+};
+
+void Test20()
+{
+    NodeReclaimer reclaimer(16);
+    assert(reclaimer.batch_size() == 16u);
+    reclaimer.drain();
+
+    {
+        // The head of each list holds a value as well.
+        SingleLinkedList<LiveCounted> big;
+        SingleLinkedList<LiveCounted> other;
+        SingleLinkedList<LiveCounted> small;
+        const int heads = LiveCounted::live.load();
+        for (int i = 0; i < 1000; ++i)
+        {
+            big.emplace_front();
+            other.emplace_front();
+        }
+        assert(LiveCounted::live.load() == heads + 2000);
+
+        big.clear_async(reclaimer);
+        other.clear_async(reclaimer);
+        assert(big.empty() && big.begin() == big.end() && other.empty());
+        big.emplace_front();
+        reclaimer.drain();
+        assert(LiveCounted::live.load() == heads + 1);
+
+        // A list that fits one batch is cleared on the calling thread.
+        for (int i = 0; i < 16; ++i)
+        {
+            small.emplace_front();
+        }
+        small.clear_async(reclaimer);
+        assert(small.empty() && LiveCounted::live.load() == heads + 1);
+    }
+    assert(LiveCounted::live.load() == 0);
+
+    {
+        using Queue = SingleLinkedList<int, std::allocator<int>, TailTracking, ListStats, NoInlineNodes, Fingerprint>;
+        Queue queue;
+        for (int i = 0; i < 100; ++i)
+        {
+            queue.push_back(i);
+        }
+        queue.clear_async(reclaimer);
+        assert(queue.empty() && queue.stats().deallocations == 100u);
+        assert(queue.hash() == Queue{}.hash());
+        queue.push_back(7);
+        assert(queue.back() == 7 && queue == Queue{ 7 });
+    }
+
+    // The destructor finishes queued work.
+    {
+        SingleLinkedList<LiveCounted> list;
+        const int heads = LiveCounted::live.load();
+        {
+            NodeReclaimer local(1);
+            for (int i = 0; i < 500; ++i)
+            {
+                list.emplace_front();
+            }
+            list.clear_async(local);
+        }
+        assert(LiveCounted::live.load() == heads);
+    }
+}
+
+void Test21()
+{
+    {
+        SingleLinkedList<int> list{ 1, 5 };
+        const std::vector<int> values{ 2, 3, 4 };
+        auto last = list.insert_after(list.begin(), values.begin(), values.end());
+        assert(*last == 4 && (list == SingleLinkedList<int>{ 1, 2, 3, 4, 5 }));
+        last = list.insert_after(last, 2, 9);
+        assert(*last == 9 && *std::next(last) == 5 && list.size() == 7u);
+        last = list.insert_after(list.before_begin(), { 7, 8 });
+        assert(*last == 8 && (list == SingleLinkedList<int>{ 7, 8, 1, 2, 3, 4, 9, 9, 5 }));
+        assert(list.insert_after(list.begin(), values.end(), values.end()) == list.begin());
+        assert(list.insert_after(list.begin(), 0, 1) == list.begin() && list.size() == 9u);
+
+        std::istringstream input("10 11 12");
+        last = list.insert_after(list.before_begin(), std::istream_iterator<int>(input), std::istream_iterator<int>());
+        assert(*last == 12 && list.size() == 12u && *list.begin() == 10);
+
+        SingleLinkedList<int> big;
+        big.insert_after(big.before_begin(), 1000, 3);
+        assert(big.size() == 1000u && std::count(big.begin(), big.end(), 3) == 1000);
+    }
+
+    {
+        using TailList = SingleLinkedList<int, std::allocator<int>, TailTracking, NoListStats, InlineNodes<4>, Fingerprint>;
+        TailList list{ 1 };
+        list.insert_after(list.before_end(), { 2, 3, 4, 5, 6 });
+        assert(list.back() == 6 && list.size() == 6u);
+        list.push_back(7);
+        assert((list == TailList{ 1, 2, 3, 4, 5, 6, 7 }) && list.hash() == TailList(list).hash());
+
+        list.assign({ 9, 8 });
+        assert((list == TailList{ 9, 8 }) && list.back() == 8 && list.hash() == (TailList{ 9, 8 }.hash()));
+        list.assign(5, 4);
+        assert((list == TailList{ 4, 4, 4, 4, 4 }) && list.back() == 4);
+        list.push_back(1);
+        assert(list.back() == 1 && list.hash() == (TailList{ 4, 4, 4, 4, 4, 1 }.hash()));
+    }
+
+    // assign reuses the nodes it already has.
+    {
+        int live = 0;
+        SingleLinkedList<std::string, CountingAllocator<std::string>> list({ "a"s, "b"s, "c"s }, CountingAllocator<std::string>(&live));
+        const std::string* second = &*std::next(list.begin());
+        const std::vector<std::string> shorter{ "x"s, "y"s };
+        list.assign(shorter.begin(), shorter.end());
+        assert(live == 2 && &*std::next(list.begin()) == second);
+        assert(std::equal(list.begin(), list.end(), shorter.begin(), shorter.end()));
+        list.assign(4, "z"s);
+        assert(live == 4 && &*std::next(list.begin()) == second && list.size() == 4u);
+        list.assign(shorter.end(), shorter.end());
+        assert(live == 0 && list.empty());
+    }
+
+    struct ThrowingCopy
+    {
+        ThrowingCopy() = default;
+        explicit ThrowingCopy(int* countdown) noexcept : countdown_ptr(countdown) {}
+
+        ThrowingCopy(const ThrowingCopy& other) : countdown_ptr(other.countdown_ptr)
+        {
+            if (countdown_ptr != nullptr && (*countdown_ptr)-- == 0)
+            {
+                throw std::runtime_error("copy failed");
+            }
+        }
+
+        int* countdown_ptr = nullptr;
+    };
+
+    // A throwing copy leaves the list as it was and leaks nothing.
+    for (const int copies_before_throw : { 0, 3, 70 })
+    {
+        int live = 0;
+        int countdown = std::numeric_limits<int>::max();
+        SingleLinkedList<ThrowingCopy, CountingAllocator<ThrowingCopy>> list{ CountingAllocator<ThrowingCopy>(&live) };
+        list.push_front(ThrowingCopy(&countdown));
+        list.push_front(ThrowingCopy(&countdown));
+        const auto* first = &*list.begin();
+        const std::vector<ThrowingCopy> values(100, ThrowingCopy(&countdown));
+
+        countdown = copies_before_throw;
+        bool thrown = false;
+        try
+        {
+            list.insert_after(list.begin(), values.begin(), values.end());
+        }
+        catch (const std::runtime_error&)
+        {
+            thrown = true;
+        }
+        assert(thrown && live == 2 && list.size() == 2u && &*list.begin() == first);
+
+        countdown = copies_before_throw;
+        thrown = false;
+        try
+        {
+            list.insert_after(list.before_begin(), 80, values.front());
+        }
+        catch (const std::runtime_error&)
+        {
+            thrown = true;
+        }
+        assert(thrown == (copies_before_throw < 80) && live == (thrown ? 2 : 82));
+    }
+}
+
+void Test22()
+{
+    {
+        SingleLinkedList<int> list{ 1, 2, 3, 4, 5, 6 };
+        auto it = list.erase_after(list.begin(), std::next(list.begin(), 3));
+        assert(*it == 4 && (list == SingleLinkedList<int>{ 1, 4, 5, 6 }));
+        assert(list.erase_after(list.begin(), std::next(list.begin())) == std::next(list.begin()) && list.size() == 4u);
+        assert(list.erase_after(list.begin(), list.end()) == list.end());
+        assert((list == SingleLinkedList<int>{ 1 }));
+        list.erase_after(list.before_begin(), list.end());
+        assert(list.empty() && list.begin() == list.end());
+    }
+
+    {
+        SingleLinkedList<int> list{ 1, 2, 3, 2, 2, 4, 2 };
+        assert(list.remove(2) == 4u && (list == SingleLinkedList<int>{ 1, 3, 4 }));
+        assert(list.remove(7) == 0u && list.size() == 3u);
+        // The value may be an element of the list itself.
+        list.push_front(4);
+        assert(list.remove(*list.begin()) == 2u && (list == SingleLinkedList<int>{ 1, 3 }));
+        assert(list.remove_if([](int value) { return value % 2 == 1; }) == 2u && list.empty());
+
+        list = SingleLinkedList<int>{ 1, 1, 2, 2, 2, 3, 1, 1 };
+        assert(list.unique() == 4u && (list == SingleLinkedList<int>{ 1, 2, 3, 1 }));
+        list = SingleLinkedList<int>{ 1, 2, 4, 5, 7, 8, 20 };
+        assert(list.unique([](int kept, int value) { return value - kept < 3; }) == 3u);
+        assert((list == SingleLinkedList<int>{ 1, 4, 7, 20 }));
+
+        list.reverse();
+        assert((list == SingleLinkedList<int>{ 20, 7, 4, 1 }));
+        SingleLinkedList<int> empty;
+        empty.reverse();
+        assert(empty.empty() && empty.unique() == 0u);
+    }
+
+    {
+        using TailList = SingleLinkedList<int, std::allocator<int>, TailTracking, NoListStats, NoInlineNodes, Fingerprint>;
+        const auto consistent = [](const TailList& list) {
+            return list.hash() == TailList(list).hash() && (list.empty() || list.back() == *std::next(list.begin(), list.size() - 1));
+        };
+        TailList list{ 1, 2, 3, 3, 4, 5, 6, 6 };
+        list.reverse();
+        assert(list.back() == 1 && consistent(list));
+        assert(list.unique() == 2u && consistent(list));
+        assert(list.remove_if([](int value) { return value < 3; }) == 2u && list.back() == 3 && consistent(list));
+        list.erase_after(std::next(list.begin()), list.end());
+        assert((list == TailList{ 6, 5 }) && consistent(list));
+        list.push_back(9);
+        assert((list == TailList{ 6, 5, 9 }) && consistent(list));
+    }
+
+    // Removed nodes are freed, also when the predicate throws part way.
+    {
+        int live = 0;
+        SingleLinkedList<int, CountingAllocator<int>> list({ 1, 2, 3, 4, 5, 6 }, CountingAllocator<int>(&live));
+        bool thrown = false;
+        try
+        {
+            list.remove_if([](int value) {
+                if (value == 5)
+                {
+                    throw std::runtime_error("predicate failed");
+                }
+                return value % 2 == 0;
+            });
+        }
+        catch (const std::runtime_error&)
+        {
+            thrown = true;
+        }
+        assert(thrown && live == 4 && (list == SingleLinkedList<int, CountingAllocator<int>>({ 1, 3, 5, 6 }, CountingAllocator<int>(&live))));
+        list.erase_after(list.before_begin(), list.end());
+        assert(live == 0 && list.empty());
+    }
+}
+
+void Test23()
+{
+    {
+        SingleLinkedList<int> list{ 10, 11, 12, 13, 14 };
+        assert(list.at(0) == 10 && list.at(4) == 14);
+        assert(*list.iterator_at(2) == 12 && list.iterator_at(5) == list.end());
+        assert(*list.advance(list.before_begin(), 1) == 10 && list.advance(list.begin(), 4) == std::next(list.begin(), 4));
+        bool thrown = false;
+        try
+        {
+            static_cast<void>(std::as_const(list).at(5));
+        }
+        catch (const std::out_of_range&)
+        {
+            thrown = true;
+        }
+        assert(thrown);
+
+        SingleLinkedList<int> rest = list.split_at(2);
+        assert((list == SingleLinkedList<int>{ 10, 11 }) && (rest == SingleLinkedList<int>{ 12, 13, 14 }));
+        assert(list.split_at(2).empty() && list.split_at(0).size() == 2u && list.empty());
+    }
+
+    {
+        using IndexedList = SingleLinkedList<int, std::allocator<int>, NoTailTracking, NoListStats, NoInlineNodes, NoFingerprint, PositionIndex<4>>;
+        const auto positions_hold = [](IndexedList& list) {
+            const IndexedList& const_list = list;
+            std::vector<int> expected(list.begin(), list.end());
+            for (size_t k = 0; k < expected.size(); ++k)
+            {
+                if (list.at(k) != expected[k] || const_list.at(k) != expected[k] || *const_list.iterator_at(k) != expected[k])
+                {
+                    return false;
+                }
+                for (size_t n : { size_t{ 1 }, size_t{ 5 }, size_t{ 9 }, expected.size() - k })
+                {
+                    if (k + n <= expected.size() &&
+                        (list.advance(list.iterator_at(k), n) != std::next(list.begin(), k + n) ||
+                            const_list.advance(const_list.iterator_at(k), n) != std::next(const_list.begin(), k + n)))
+                    {
+                        return false;
+                    }
+                }
+            }
+            return list.iterator_at(expected.size()) == list.end();
+        };
+
+        IndexedList list;
+        for (int i = 99; i >= 0; --i)
+        {
+            list.push_front(i);
+        }
+        const IndexedList& const_list = list;
+        // Without a built index the const overloads walk.
+        assert(const_list.at(97) == 97 && *const_list.advance(const_list.before_begin(), 50) == 49);
+        list.build_index();
+        assert(const_list.at(97) == 97 && positions_hold(list));
+        // Positions just past the last element come from the index too, and are end().
+        assert(list.iterator_at(list.size()) == list.end() && const_list.iterator_at(list.size()) == const_list.end());
+        assert(list.advance(list.begin(), list.size()) == list.end() && list.advance(list.iterator_at(96), 4) == list.end());
+        assert(const_list.advance(const_list.before_begin(), list.size() + 1) == const_list.end());
+
+        // Every change to the links drops the index, and the next access rebuilds it.
+        list.push_front(-1);
+        assert(list.at(50) == 49 && positions_hold(list));
+        list.erase(list.iterator_at(10));
+        list.insert(list.iterator_at(60), 1000);
+        assert(positions_hold(list));
+        list.reverse();
+        assert(positions_hold(list));
+        list.sort();
+        assert(positions_hold(list));
+        list.remove_if([](int value) { return value % 3 == 0; });
+        assert(positions_hold(list));
+        IndexedList other{ -5, -6, -7 };
+        list.splice_after(list.iterator_at(20), other);
+        assert(positions_hold(list) && other.empty() && positions_hold(other));
+        std::swap(list, other);
+        assert(positions_hold(list) && positions_hold(other));
+        std::swap(list, other);
+
+        // A split keeps the checkpoints in front of the cut.
+        std::vector<int> values(list.begin(), list.end());
+        IndexedList rest = list.split_at(41);
+        assert(list.size() == 41u && rest.size() == values.size() - 41);
+        assert(std::equal(list.begin(), list.end(), values.begin()) && std::equal(rest.begin(), rest.end(), values.begin() + 41));
+        assert(const_list.at(40) == values[40] && positions_hold(list) && positions_hold(rest));
+        IndexedList tail = list.split_at(8);
+        assert(list.size() == 8u && tail.size() == 33u && tail.at(0) == values[8] && positions_hold(list));
+    }
+
+    {
+        using IndexedList = SingleLinkedList<int, std::allocator<int>, TailTracking, NoListStats, InlineNodes<4>, Fingerprint, PositionIndex<2>>;
+        IndexedList list{ 1, 2, 3, 4, 5, 6, 7, 8, 9 };
+        IndexedList rest = list.split_at(2);
+        assert(list.back() == 2 && rest.back() == 9 && rest.at(6) == 9);
+        assert(list.hash() == IndexedList({ 1, 2 }).hash() && rest.hash() == IndexedList({ 3, 4, 5, 6, 7, 8, 9 }).hash());
+        rest.push_back(10);
+        list.push_back(3);
+        assert(rest.at(7) == 10 && (list == IndexedList{ 1, 2, 3 }));
+        IndexedList whole = rest.split_at(0);
+        assert(rest.empty() && rest.hash() == IndexedList().hash() && whole.size() == 8u && whole.back() == 10);
+        rest.push_back(1);
+        assert(rest.at(0) == 1 && rest.back() == 1);
+    }
+}
+
+void Test24()
+{
+    {
+        SortedList<int> list{ 5, 1, 4 };
+        assert((list.list() == SingleLinkedList<int>{ 1, 4, 5 }));
+        assert(*list.insert_sorted(3) == 3 && *list.insert_sorted(6) == 6 && *list.insert_sorted(0) == 0);
+        assert((list.list() == SingleLinkedList<int>{ 0, 1, 3, 4, 5, 6 }));
+
+        assert(*list.lower_bound(2) == 3 && *list.lower_bound(4) == 4 && list.lower_bound(7) == list.end());
+        // Searches behind the finger start over from the front.
+        assert(*list.lower_bound(-1) == 0 && *list.find(5) == 5 && list.find(2) == list.end());
+        assert(list.contains(1) && !list.contains(7));
+        const SortedList<int>& const_list = list;
+        assert(*const_list.find(6) == 6 && *const_list.lower_bound(2) == 3);
+
+        assert(list.erase(3) == 1u && list.erase(3) == 0u && *list.erase_after(list.begin()) == 4);
+        list.pop_front();
+        assert((list.list() == SingleLinkedList<int>{ 4, 5, 6 }));
+
+        list.insert_sorted({ 9, 2, 5, 7 });
+        assert((list.list() == SingleLinkedList<int>{ 2, 4, 5, 5, 6, 7, 9 }));
+        assert(list.erase(5) == 2u && list.size() == 5u && *list.find(6) == 6);
+        SingleLinkedList<int> plain = list.release();
+        assert(list.empty() && plain.size() == 5u);
+    }
+
+    {
+        // Equivalent elements keep their insertion order, also when merged in as a batch.
+        using Entry = std::pair<int, int>;
+        const auto by_key = [](const Entry& lhs, const Entry& rhs) {
+            return lhs.first < rhs.first;
+        };
+        SortedList<Entry, decltype(by_key)> list(by_key);
+        list.insert_sorted(Entry{ 2, 0 });
+        list.insert_sorted(Entry{ 1, 1 });
+        list.insert_sorted(Entry{ 2, 2 });
+        const std::vector<Entry> batch{ { 2, 3 }, { 0, 4 }, { 1, 5 }, { 2, 6 } };
+        list.insert_sorted(batch.begin(), batch.end());
+        const std::vector<Entry> expected{ { 0, 4 }, { 1, 1 }, { 1, 5 }, { 2, 0 }, { 2, 2 }, { 2, 3 }, { 2, 6 } };
+        assert(std::equal(list.begin(), list.end(), expected.begin(), expected.end()));
+        assert(list.find(Entry{ 2, -1 })->second == 0 && list.erase(Entry{ 1, -1 }) == 2u);
+        assert(list.find(Entry{ 2, -1 })->second == 0 && list.find(Entry{ 0, -1 })->second == 4);
+    }
+
+    {
+        // Ascending insertions, lookups and erasures keep the finger valid.
+        std::mt19937 random(24);
+        SortedList<int> list;
+        std::vector<int> reference;
+        for (int i = 0; i < 2000; ++i)
+        {
+            const int value = static_cast<int>(random() % 200);
+            switch (random() % 4)
+            {
+            case 0:
+                list.insert_sorted(value);
+                reference.insert(std::upper_bound(reference.begin(), reference.end(), value), value);
+                break;
+            case 1:
+            {
+                const auto found = list.find(value);
+                const bool present = std::binary_search(reference.begin(), reference.end(), value);
+                assert(present ? found != list.end() && *found == value : found == list.end());
+                break;
+            }
+            case 2:
+            {
+                const auto range = std::equal_range(reference.begin(), reference.end(), value);
+                assert(list.erase(value) == static_cast<size_t>(range.second - range.first));
+                reference.erase(range.first, range.second);
+                break;
+            }
+            default:
+            {
+                const std::vector<int> batch{ value, value / 2, value + 3 };
+                list.insert_sorted(batch.begin(), batch.end());
+                for (const int element : batch)
+                {
+                    reference.insert(std::upper_bound(reference.begin(), reference.end(), element), element);
+                }
+                break;
+            }
+            }
+            assert(list.size() == reference.size());
+        }
+        assert(std::equal(list.begin(), list.end(), reference.begin(), reference.end()));
+
+        SortedList<int> copy(list);
+        SortedList<int> moved(std::move(list));
+        assert(copy == moved && list.empty());
+        list = copy;
+        assert(list == moved && list.lower_bound(100) == std::lower_bound(list.begin(), list.end(), 100));
+    }
+
+    {
+        // A comparator that throws while a batch is sorted leaves the list unchanged; while
+        // it is merged in, the list keeps every element.
+        struct ThrowingLess
+        {
+            int* calls_left;
+
+            bool operator()(int lhs, int rhs) const
+            {
+                if (--*calls_left == 0)
+                {
+                    throw std::runtime_error("comparison failed");
+                }
+                return lhs < rhs;
+            }
+        };
+        int live_nodes = 0;
+        int calls_left = 0;
+        {
+            SortedList<int, ThrowingLess, CountingAllocator<int>> list(ThrowingLess{ &calls_left }, CountingAllocator<int>(&live_nodes));
+            list.insert_sorted({ 0, 3, 5 });
+            assert(*list.lower_bound(4) == 5);
+
+            calls_left = 1;
+            const std::vector<int> batch{ 2, 1 };
+            try
+            {
+                list.insert_sorted(batch.begin(), batch.end());
+                assert(false);
+            }
+            catch (const std::runtime_error&)
+            {
+            }
+            const std::vector<int> unchanged{ 0, 3, 5 };
+            assert(live_nodes == 3 && std::equal(list.begin(), list.end(), unchanged.begin(), unchanged.end()));
+
+            // Sorting the batch takes one comparison, so the merge throws on its first.
+            calls_left = 2;
+            try
+            {
+                list.insert_sorted(batch.begin(), batch.end());
+                assert(false);
+            }
+            catch (const std::runtime_error&)
+            {
+            }
+            assert(live_nodes == 5 && list.size() == 5u && static_cast<size_t>(std::distance(list.begin(), list.end())) == 5u);
+            std::vector<int> values(list.begin(), list.end());
+            std::sort(values.begin(), values.end());
+            assert((values == std::vector<int>{ 0, 1, 2, 3, 5 }));
+
+            calls_left = -1;
+            list.clear();
+            list.insert_sorted({ 4, 2 });
+            assert(*list.lower_bound(3) == 4);
+        }
+        assert(live_nodes == 0);
+    }
+}
+
+void Test25()
+{
+    {
+        int live = 0;
+        {
+            MpscQueue<std::string, CountingAllocator<std::string>> queue{ CountingAllocator<std::string>(&live) };
+            assert(queue.empty() && !queue.try_pop() && live == 1);
+            queue.push("a");
+            queue.emplace(2, 'b');
+            assert(!queue.empty() && *queue.try_pop() == "a");
+
+            auto producer = queue.producer();
+            producer.push("c");
+            producer.emplace("d");
+            assert(live == 4);
+            {
+                // The drained list allocates through the queue's allocator.
+                const SingleLinkedList<std::string, CountingAllocator<std::string>> drained = queue.drain();
+                const std::vector<std::string> expected{ "bb", "c", "d" };
+                assert(std::equal(drained.begin(), drained.end(), expected.begin(), expected.end()) && queue.empty());
+                assert(drained.get_allocator() == CountingAllocator<std::string>(&live) && live == 7);
+            }
+
+            // The drained nodes are recycled, so the producer stops allocating.
+            for (int round = 0; round < 3; ++round)
+            {
+                for (const char* value : { "e", "f", "g" })
+                {
+                    producer.push(value);
+                }
+                std::string joined;
+                assert(queue.drain([&joined](std::string&& value) { joined += value; }) == 3u && joined == "efg");
+            }
+            assert(live == 4);
+
+            queue.push("h");
+            queue.push("i");
+            queue.push("j");
+            bool thrown = false;
+            try
+            {
+                static_cast<void>(queue.drain([](std::string&& value) {
+                    if (value == "i")
+                    {
+                        throw std::runtime_error("drain");
+                    }
+                }));
+            }
+            catch (const std::runtime_error&)
+            {
+                thrown = true;
+            }
+            assert(thrown && *queue.try_pop() == "j" && queue.empty());
+            queue.push("k");
+        }
+        // The queued element, the dummy, the free list and the producer's stock are all freed.
+        assert(live == 0);
+    }
+
+    {
+        constexpr size_t kProducers = 4;
+        constexpr size_t kPerProducer = 20000;
+        MpscQueue<std::pair<size_t, size_t>> queue;
+        std::vector<std::thread> producers;
+        for (size_t p = 0; p < kProducers; ++p)
+        {
+            producers.emplace_back([&queue, p]() {
+                auto producer = queue.producer();
+                for (size_t i = 0; i < kPerProducer; ++i)
+                {
+                    if (i % 3 == 0)
+                    {
+                        queue.emplace(p, i);
+                    }
+                    else
+                    {
+                        producer.emplace(p, i);
+                    }
+                }
+            });
+        }
+
+        // Each producer's elements arrive in the order it pushed them.
+        std::vector<size_t> next(kProducers, 0);
+        size_t received = 0;
+        while (received < kProducers * kPerProducer)
+        {
+            received += queue.drain([&next](std::pair<size_t, size_t>&& element) {
+                assert(element.second == next[element.first]);
+                ++next[element.first];
+            });
+            if (const auto element = queue.try_pop())
+            {
+                assert(element->second == next[element->first]);
+                ++next[element->first];
+                ++received;
+            }
+        }
+        for (auto& producer : producers)
+        {
+            producer.join();
+        }
+        assert(queue.empty() && std::all_of(next.begin(), next.end(), [](size_t count) { return count == kPerProducer; }));
+        queue.release_free_nodes();
+    }
+}
+
+#if CUSTOM_LIST_CONSTEXPR_CONTAINER
+// Primes below limit by trial division against the primes found so far, kept in a list.
+constexpr SingleLinkedList<int> ConstexprPrimes(int limit)
+{
+    SingleLinkedList<int> primes;
+    auto last = primes.before_begin();
+    for (int candidate = 2; candidate < limit; ++candidate)
+    {
+        bool prime = true;
+        for (const int divisor : primes)
+        {
+            prime = prime && candidate % divisor != 0;
+        }
+        if (prime)
+        {
+            last = primes.insert(last, candidate);
+        }
+    }
+    return primes;
+}
+
+constexpr bool ConstexprListOperations()
+{
+    SingleLinkedList<int> list{ 3, 1, 2 };
+    list.push_front(4);
+    list.insert(list.begin(), 5);
+    list.erase(list.before_begin());
+    list.pop_front();
+    list.emplace_front(6);
+    SingleLinkedList<int> copy(list);
+    copy.sort();
+    copy.reverse();
+    list.erase_after(list.begin(), list.end());
+    list.assign({ 7, 8 });
+    list.swap(copy);
+    const bool ok = (list == SingleLinkedList<int>{ 6, 3, 2, 1 }) && (copy == SingleLinkedList<int>{ 7, 8 }) && list < copy && list.at(1) == 3 &&
+        *list.advance(list.before_begin(), 4) == 1 && list.size() == 4;
+    copy = std::move(list);
+    list = copy;
+    list.clear();
+    return ok && list.empty() && copy.size() == 4;
+}
+
+constexpr size_t kConstexprPrimeCount = ConstexprPrimes(50).size();
+constexpr auto kConstexprPrimes = ToArray<kConstexprPrimeCount>(ConstexprPrimes(50));
+static_assert(kConstexprPrimeCount == 15 && kConstexprPrimes[0] == 2 && kConstexprPrimes[14] == 47);
+static_assert(ConstexprListOperations());
+#endif
+
+void Test26()
+{
+#if CUSTOM_LIST_CONSTEXPR_CONTAINER
+    // The table lives in static storage; at run time it matches a list built the usual way.
+    const SingleLinkedList<int> primes = ConstexprPrimes(50);
+    assert(std::equal(kConstexprPrimes.begin(), kConstexprPrimes.end(), primes.begin(), primes.end()));
+    assert(ConstexprListOperations());
+#endif
+    const auto table = ToArray<3>(SingleLinkedList<std::string>{ "a", "b", "c" });
+    assert(table[0] == "a" && table[2] == "c");
+}
+
+void Test27()
+{
+    {
+        CompactList<int> list{ 1, 2, 3 };
+        assert(list.size() == 3u && *list.begin() == 1);
+        // Erased slots are reused before the array grows.
+        assert(*list.erase(list.begin()) == 3);
+        const size_t slots = list.capacity();
+        auto it = list.insert(list.begin(), 7);
+        assert(*it == 7 && list.capacity() == slots);
+        assert((list == CompactList<int>{ 1, 7, 3 }));
+
+        // Iterators survive growth of the array.
+        const auto first = list.begin();
+        for (int i = 0; i < 100; ++i)
+        {
+            it = list.insert(it, i);
+        }
+        assert(*first == 1 && *std::next(first) == 7 && *std::next(first, 2) == 0 && list.size() == 103u);
+
+        list.pop_front();
+        list.emplace_front(5);
+        list.push_front(4);
+        assert(*list.begin() == 4 && *std::next(list.begin()) == 5 && *std::next(list.begin(), 2) == 7);
+        const auto after_erased = list.erase(list.before_begin());
+        assert(after_erased == list.begin() && *list.begin() == 5);
+
+        const CompactList<int> copy = list;
+        assert(copy == list && copy.capacity() >= copy.size());
+        assert(std::equal(copy.cbegin(), copy.cend(), list.begin(), list.end()));
+        CompactList<int> moved = std::move(list);
+        assert(moved == copy && list.empty() && list.begin() == list.end());
+        list = moved;
+        assert(list == copy);
+        moved.clear();
+        assert(moved.empty() && moved.begin() == moved.end() && moved < list);
+        swap(moved, list);
+        assert(list.empty() && moved == copy);
+    }
+
+    {
+        // Compacting lays the elements out in list order and drops the free slots.
+        CompactList<int> list;
+        for (int i = 0; i < 10; ++i)
+        {
+            list.push_front(i);
+        }
+        for (auto it = list.before_begin(); std::next(it) != list.end(); ++it)
+        {
+            list.erase(it);
+        }
+        assert((list == CompactList<int>{ 8, 6, 4, 2, 0 }));
+        list.compact();
+        assert((list == CompactList<int>{ 8, 6, 4, 2, 0 }) && list.capacity() == 5u);
+        for (auto it = list.begin(); std::next(it) != list.end(); ++it)
+        {
+            assert(&*it < &*std::next(it));
+        }
+        list.push_front(10);
+        assert(*list.begin() == 10 && list.size() == 6u);
+    }
+
+    {
+        // Freed slots release what their values owned.
+        CompactList<std::shared_ptr<int>> list;
+        const auto shared = std::make_shared<int>(1);
+        list.push_front(shared);
+        list.push_front(shared);
+        assert(shared.use_count() == 3);
+        list.pop_front();
+        assert(shared.use_count() == 2);
+        list.clear();
+        assert(shared.use_count() == 1);
+    }
+
+    {
+        // A value that fails to construct leaves the list unchanged.
+        struct Throwing
+        {
+            Throwing() = default;
+            explicit Throwing(bool fail)
+            {
+                if (fail)
+                {
+                    throw std::runtime_error("construction failed");
+                }
+            }
+        };
+        CompactList<Throwing> list;
+        list.emplace_front(false);
+        list.emplace_front(false);
+        list.pop_front();
+        // Once into the free slot, once into a new one.
+        for (int attempt = 0; attempt < 2; ++attempt)
+        {
+            try
+            {
+                list.emplace_front(true);
+                assert(false);
+            }
+            catch (const std::runtime_error&)
+            {
+            }
+            assert(list.size() == static_cast<size_t>(attempt + 1));
+            list.emplace_front(false);
+        }
+        assert(list.size() == 3u && list.capacity() >= 3u);
+    }
+
+    {
+        // An int element costs its value and a 32-bit link.
+        CompactList<int> list;
+        list.reserve(1000);
+        for (int i = 0; i < 1000; ++i)
+        {
+            list.push_front(i);
+        }
+        assert(list.memory_footprint() - sizeof(list) == 1000 * (sizeof(int) + sizeof(uint32_t)));
+    }
+}
+
+#if CUSTOM_LIST_RANGES
+static_assert(std::forward_iterator<SingleLinkedList<int>::Iterator> && std::forward_iterator<SingleLinkedList<int>::ConstIterator>);
+static_assert(std::equality_comparable_with<SingleLinkedList<int>::Iterator, SingleLinkedList<int>::ConstIterator>);
+static_assert(std::ranges::forward_range<SingleLinkedList<int>> && std::ranges::common_range<const SingleLinkedList<int>>);
+static_assert(std::ranges::forward_range<CompactList<int>> && std::ranges::forward_range<const CompactList<int>>);
+#endif
+
+void Test28()
+{
+#if CUSTOM_LIST_RANGES
+    const SingleLinkedList<int> values{ 1, 2, 3, 4, 5, 6, 7, 8, 9, 10 };
+    const auto is_even = [](int value) {
+        return value % 2 == 0;
+    };
+    const auto triple = [](int value) {
+        return 3 * value;
+    };
+
+    // take() ends the pipeline in a sentinel of its own type.
+    auto tripled = values | std::views::filter(is_even) | std::views::transform(triple) | std::views::take(3) | ToList();
+    static_assert(std::is_same_v<decltype(tripled), SingleLinkedList<int>>);
+    assert((tripled == SingleLinkedList<int>{ 6, 12, 18 }));
+    assert(std::ranges::find(tripled, 12) == std::next(tripled.begin()) && std::ranges::count_if(values, is_even) == 5);
+
+    const SingleLinkedList<long> longs(kFromRange, std::views::iota(0, 4));
+    assert((longs == SingleLinkedList<long>{ 0, 1, 2, 3 }));
+    auto with_tail = values | std::views::drop(8) | ToList<SingleLinkedList<int, std::allocator<int>, TailTracking>>();
+    assert(with_tail.size() == 2u && with_tail.back() == 10);
+    assert((ToList()(std::views::empty<int>).empty()));
+
+    const std::vector<int> vector{ 3, 1, 2 };
+    const SingleLinkedList<int> from_iterators(vector.begin(), vector.end());
+    assert((from_iterators == SingleLinkedList<int>{ 3, 1, 2 }));
+
+    // Iterators and const iterators compare equal through the standard concepts too.
+    SingleLinkedList<int> list = from_iterators;
+    SingleLinkedList<int>::ConstIterator second = std::ranges::next(list.cbegin());
+    assert(std::ranges::next(list.begin()) == second && std::ranges::distance(list) == 3);
+#endif
+}
+
 void GeneralizingTest()
 {
     Test0();
@@ -556,4 +3121,28 @@ void GeneralizingTest()
     Test2();
     Test3();
     Test4();
+    Test5();
+    Test6();
+    Test7();
+    Test8();
+    Test9();
+    Test10();
+    Test11();
+    Test12();
+    Test13();
+    Test14();
+    Test15();
+    Test16();
+    Test17();
+    Test18();
+    Test19();
+    Test20();
+    Test21();
+    Test22();
+    Test23();
+    Test24();
+    Test25();
+    Test26();
+    Test27();
+    Test28();
 }
\ No newline at end of file
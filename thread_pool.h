@@ -0,0 +1,295 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+// Fixed set of worker threads with one task deque each. A worker runs its own tasks newest
+// first and, when it runs dry, steals the oldest task of another worker, so a burst of tasks
+// submitted to one deque spreads over all workers. Threads waiting for a TaskGroup run
+// pending tasks instead of blocking, which also makes nested parallelism safe.
+class WorkStealingThreadPool
+{
+public:
+    // worker_count threads run tasks next to the thread that waits for them, so a pool with
+    // n - 1 workers keeps n cores busy. A pool without workers runs every task on the waiter.
+    explicit WorkStealingThreadPool(size_t worker_count = default_worker_count())
+        : queues_(std::max<size_t>(worker_count, 1))
+    {
+        for (auto& queue : queues_)
+        {
+            queue = std::make_unique<TaskQueue>();
+        }
+        workers_.reserve(worker_count);
+        try
+        {
+            for (size_t i = 0; i < worker_count; ++i)
+            {
+                workers_.emplace_back([this, i]() {
+                    work(i);
+                });
+            }
+        }
+        catch (...)
+        {
+            stop();
+            throw;
+        }
+    }
+
+    WorkStealingThreadPool(const WorkStealingThreadPool&) = delete;
+    WorkStealingThreadPool& operator=(const WorkStealingThreadPool&) = delete;
+
+    // Runs all tasks still queued, then joins the workers.
+    ~WorkStealingThreadPool()
+    {
+        stop();
+    }
+
+    [[nodiscard]] static size_t default_worker_count() noexcept
+    {
+        return std::max<size_t>(std::thread::hardware_concurrency(), 1) - 1;
+    }
+
+    // Process-wide pool with default_worker_count() workers, created on first use.
+    [[nodiscard]] static WorkStealingThreadPool& shared()
+    {
+        static WorkStealingThreadPool pool;
+        return pool;
+    }
+
+    [[nodiscard]] size_t worker_count() const noexcept
+    {
+        return workers_.size();
+    }
+
+    // Number of threads that run tasks while one thread waits for them.
+    [[nodiscard]] size_t concurrency() const noexcept
+    {
+        return workers_.size() + 1;
+    }
+
+    // Queues task, which must not throw. Workers push to their own deque, other threads
+    // spread tasks round robin. Use TaskGroup to wait for tasks and collect their exceptions.
+    void submit(std::function<void()> task)
+    {
+        const size_t index = current_owner() == this ? current_index() : next_queue_.fetch_add(1, std::memory_order_relaxed) % queues_.size();
+        {
+            std::lock_guard lock(queues_[index]->mutex);
+            queues_[index]->tasks.push_back(std::move(task));
+            std::lock_guard sleep_lock(sleep_mutex_);
+            ++pending_;
+        }
+        wake_.notify_one();
+    }
+
+    // Runs one queued task on the calling thread, preferring its own deque. Returns false if
+    // no task was found.
+    bool run_pending_task()
+    {
+        const size_t home = current_owner() == this ? current_index() : 0;
+        std::function<void()> task;
+        if (!take(home, task))
+        {
+            return false;
+        }
+        task();
+        return true;
+    }
+
+private:
+    struct TaskQueue
+    {
+        std::mutex mutex;
+        std::deque<std::function<void()>> tasks;
+    };
+
+    std::vector<std::unique_ptr<TaskQueue>> queues_;
+    std::vector<std::thread> workers_;
+    std::atomic<size_t> next_queue_{ 0 };
+
+    std::mutex sleep_mutex_;
+    std::condition_variable wake_;
+    size_t pending_ = 0;
+    bool stopping_ = false;
+
+    static WorkStealingThreadPool*& current_owner() noexcept
+    {
+        thread_local WorkStealingThreadPool* owner = nullptr;
+        return owner;
+    }
+
+    static size_t& current_index() noexcept
+    {
+        thread_local size_t index = 0;
+        return index;
+    }
+
+    // Pops the newest task of queue home, or else steals the oldest task of another queue.
+    bool take(size_t home, std::function<void()>& task)
+    {
+        for (size_t i = 0; i < queues_.size(); ++i)
+        {
+            TaskQueue& queue = *queues_[(home + i) % queues_.size()];
+            std::lock_guard lock(queue.mutex);
+            if (queue.tasks.empty())
+            {
+                continue;
+            }
+            if (i == 0)
+            {
+                task = std::move(queue.tasks.back());
+                queue.tasks.pop_back();
+            }
+            else
+            {
+                task = std::move(queue.tasks.front());
+                queue.tasks.pop_front();
+            }
+            std::lock_guard sleep_lock(sleep_mutex_);
+            --pending_;
+            return true;
+        }
+        return false;
+    }
+
+    void work(size_t index)
+    {
+        current_owner() = this;
+        current_index() = index;
+        for (;;)
+        {
+            std::function<void()> task;
+            if (take(index, task))
+            {
+                task();
+                continue;
+            }
+
+            std::unique_lock lock(sleep_mutex_);
+            wake_.wait(lock, [this]() {
+                return stopping_ || pending_ > 0;
+            });
+            if (stopping_ && pending_ == 0)
+            {
+                return;
+            }
+        }
+    }
+
+    void stop() noexcept
+    {
+        {
+            std::lock_guard lock(sleep_mutex_);
+            stopping_ = true;
+        }
+        wake_.notify_all();
+        for (auto& worker : workers_)
+        {
+            worker.join();
+        }
+        workers_.clear();
+        while (run_pending_task())
+        {
+        }
+    }
+};
+
+// Tasks run on a pool that can be waited for together. wait() executes pending pool tasks
+// while the group is unfinished and rethrows the first exception a task threw. The
+// destructor waits as well, so tasks may safely refer to the caller's locals.
+class TaskGroup
+{
+public:
+    explicit TaskGroup(WorkStealingThreadPool& pool) noexcept : pool_(pool) {}
+
+    TaskGroup(const TaskGroup&) = delete;
+    TaskGroup& operator=(const TaskGroup&) = delete;
+
+    ~TaskGroup()
+    {
+        finish();
+    }
+
+    template <typename Function>
+    void run(Function task)
+    {
+        unfinished_.fetch_add(1, std::memory_order_relaxed);
+        try
+        {
+            pool_.submit([this, task = std::move(task)]() mutable {
+                try
+                {
+                    task();
+                }
+                catch (...)
+                {
+                    std::lock_guard lock(error_mutex_);
+                    if (!error_)
+                    {
+                        error_ = std::current_exception();
+                    }
+                }
+                unfinished_.fetch_sub(1, std::memory_order_release);
+            });
+        }
+        catch (...)
+        {
+            unfinished_.fetch_sub(1, std::memory_order_relaxed);
+            throw;
+        }
+    }
+
+    void wait()
+    {
+        finish();
+        if (error_)
+        {
+            std::rethrow_exception(std::exchange(error_, nullptr));
+        }
+    }
+
+private:
+    WorkStealingThreadPool& pool_;
+    std::atomic<size_t> unfinished_{ 0 };
+    std::mutex error_mutex_;
+    std::exception_ptr error_;
+
+    void finish() noexcept
+    {
+        while (unfinished_.load(std::memory_order_acquire) != 0)
+        {
+            if (!pool_.run_pending_task())
+            {
+                std::this_thread::yield();
+            }
+        }
+    }
+};
+
+// Execution policies for the algorithms of SingleLinkedList. With SequencedPolicy they run
+// on the calling thread. With ParallelPolicy the list is cut into segments that run as
+// TaskGroup tasks on pool, or on WorkStealingThreadPool::shared() if pool is null. Zero
+// segments picks a few per pool thread; lists too short to fill min_segment_size elements
+// per segment are processed with fewer segments.
+struct SequencedPolicy
+{
+};
+
+struct ParallelPolicy
+{
+    WorkStealingThreadPool* pool = nullptr;
+    size_t segments = 0;
+    size_t min_segment_size = 4096;
+};
+
+inline constexpr SequencedPolicy kSequenced{};
+inline constexpr ParallelPolicy kParallel{};
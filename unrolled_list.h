@@ -0,0 +1,553 @@
+#pragma once
+#include <cassert>
+#include <cstddef>
+#include <iterator>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <algorithm>
+
+#include "custom_list.h"
+
+// Default number of elements per chunk: enough to fill roughly four cache lines, at least four.
+template <typename Type>
+inline constexpr size_t kDefaultUnrolledChunkCapacity = sizeof(Type) * 4 >= 256 ? 4 : 256 / sizeof(Type);
+
+// Singly linked list that stores up to ChunkCapacity elements per node in a contiguous
+// array, so traversal touches one next pointer per chunk instead of one per element.
+// Chunks are split when full and merged with their successor when less than half full.
+// Unlike SingleLinkedList, insert and erase may shift elements within a chunk, which
+// invalidates iterators into that chunk and its successor.
+template <typename Type, size_t ChunkCapacity = kDefaultUnrolledChunkCapacity<Type>, typename Allocator = std::allocator<Type>>
+class UnrolledLinkedList
+{
+    static_assert(ChunkCapacity >= 2, "a chunk must hold at least two elements to be split");
+    static_assert(std::is_nothrow_move_constructible_v<Type>, "elements are relocated within chunks");
+
+    struct ChunkBase
+    {
+        ChunkBase* next_chunk = nullptr;
+        size_t count = 0;
+    };
+
+    struct Chunk : ChunkBase
+    {
+        [[nodiscard]] Type* data() noexcept
+        {
+            return std::launder(reinterpret_cast<Type*>(storage));
+        }
+
+        alignas(Type) unsigned char storage[sizeof(Type) * ChunkCapacity];
+    };
+
+    using ChunkAllocator = typename std::allocator_traits<Allocator>::template rebind_alloc<Chunk>;
+    using ChunkAllocTraits = std::allocator_traits<ChunkAllocator>;
+
+    [[nodiscard]] static Type* values(ChunkBase* chunk) noexcept
+    {
+        return static_cast<Chunk*>(chunk)->data();
+    }
+
+    template <typename ValueType>
+    class BasicIterator
+    {
+
+        friend class UnrolledLinkedList;
+
+        BasicIterator(ChunkBase* chunk, size_t index) : chunk_(chunk), index_(index) {}
+
+    public:
+
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = Type;
+        using difference_type = std::ptrdiff_t;
+        using pointer = ValueType*;
+        using reference = ValueType&;
+
+        BasicIterator() = default;
+
+        BasicIterator(const BasicIterator<Type>& other) noexcept : chunk_(other.chunk_), index_(other.index_) {}
+
+        BasicIterator& operator=(const BasicIterator& rhs) = default;
+
+
+        [[nodiscard]] bool operator==(const BasicIterator<const Type>& rhs) const noexcept
+        {
+            return this->chunk_ == rhs.chunk_ && this->index_ == rhs.index_;
+        }
+
+        [[nodiscard]] bool operator!=(const BasicIterator<const Type>& rhs) const noexcept
+        {
+            return !(*this == rhs);
+        }
+
+        [[nodiscard]] bool operator==(const BasicIterator<Type>& rhs) const noexcept
+        {
+            return this->chunk_ == rhs.chunk_ && this->index_ == rhs.index_;
+        }
+
+        [[nodiscard]] bool operator!=(const BasicIterator<Type>& rhs) const noexcept
+        {
+            return !(*this == rhs);
+        }
+
+        BasicIterator& operator++() noexcept
+        {
+            assert(chunk_ != nullptr);
+
+            if (++index_ >= chunk_->count)
+            {
+                chunk_ = chunk_->next_chunk;
+                index_ = 0;
+            }
+            return *this;
+        }
+
+        BasicIterator operator++(int) noexcept
+        {
+            assert(chunk_ != nullptr);
+
+            auto old_value(*this);
+            ++(*this);
+            return old_value;
+        }
+
+        [[nodiscard]] reference operator*() const noexcept
+        {
+            assert(chunk_ != nullptr && index_ < chunk_->count);
+
+            return values(chunk_)[index_];
+        }
+
+        [[nodiscard]] pointer operator->() const noexcept
+        {
+            assert(chunk_ != nullptr && index_ < chunk_->count);
+
+            return values(chunk_) + index_;
+        }
+
+    private:
+        ChunkBase* chunk_ = nullptr;
+        size_t index_ = 0;
+    };
+
+public:
+    UnrolledLinkedList() {}
+
+    explicit UnrolledLinkedList(const Allocator& alloc) : chunk_alloc_(alloc) {}
+
+    UnrolledLinkedList(std::initializer_list<Type> values, const Allocator& alloc = Allocator()) : chunk_alloc_(alloc)
+    {
+        assign(values.begin(), values.end());
+    }
+
+    UnrolledLinkedList(const UnrolledLinkedList& other)
+        : chunk_alloc_(ChunkAllocTraits::select_on_container_copy_construction(other.chunk_alloc_))
+    {
+        assign(other.begin(), other.end());
+    }
+
+    UnrolledLinkedList(UnrolledLinkedList&& other) noexcept : chunk_alloc_(std::move(other.chunk_alloc_))
+    {
+        steal_chunks(other);
+    }
+
+    ~UnrolledLinkedList()
+    {
+        clear();
+    }
+
+    using value_type = Type;
+    using allocator_type = Allocator;
+    using reference = value_type&;
+    using const_reference = const value_type&;
+    using Iterator = BasicIterator<Type>;
+    using ConstIterator = BasicIterator<const Type>;
+
+    static constexpr size_t chunk_capacity = ChunkCapacity;
+
+    [[nodiscard]] allocator_type get_allocator() const noexcept
+    {
+        return allocator_type(chunk_alloc_);
+    }
+
+    [[nodiscard]] Iterator begin() noexcept
+    {
+        return Iterator{ head_.next_chunk, 0 };
+    }
+
+    [[nodiscard]] Iterator end() noexcept
+    {
+        return Iterator{ nullptr, 0 };
+    }
+
+    [[nodiscard]] ConstIterator begin() const noexcept
+    {
+        return cbegin();
+    }
+
+    [[nodiscard]] ConstIterator end() const noexcept
+    {
+        return cend();
+    }
+
+    [[nodiscard]] ConstIterator cbegin() const noexcept
+    {
+        return ConstIterator{ head_.next_chunk, 0 };
+    }
+
+    [[nodiscard]] ConstIterator cend() const noexcept
+    {
+        return ConstIterator{ nullptr, 0 };
+    }
+
+    [[nodiscard]] Iterator before_begin() noexcept
+    {
+        return Iterator{ &head_, 0 };
+    }
+
+    [[nodiscard]] ConstIterator cbefore_begin() const noexcept
+    {
+        return ConstIterator{ const_cast<ChunkBase*>(&head_), 0 };
+    }
+
+    [[nodiscard]] ConstIterator before_begin() const noexcept
+    {
+        return cbefore_begin();
+    }
+
+    Iterator insert(ConstIterator pos, const Type& value)
+    {
+        return emplace_after(pos, value);
+    }
+
+    Iterator insert(ConstIterator pos, Type&& value)
+    {
+        return emplace_after(pos, std::move(value));
+    }
+
+    template <typename... Args>
+    Iterator emplace_after(ConstIterator pos, Args&&... args)
+    {
+        assert(pos.chunk_ != nullptr);
+
+        ChunkBase* chunk = pos.chunk_;
+        size_t index = pos.index_ + 1;
+        if (chunk == &head_)
+        {
+            chunk = head_.next_chunk;
+            index = 0;
+        }
+
+        // Construct the value first so that a throwing constructor leaves the list untouched.
+        Type value(std::forward<Args>(args)...);
+
+        if (chunk == nullptr)
+        {
+            chunk = link_new_chunk(&head_);
+        }
+        else if (chunk->count == ChunkCapacity)
+        {
+            ChunkBase* next = chunk->next_chunk;
+            if (index == ChunkCapacity && next != nullptr && next->count < ChunkCapacity)
+            {
+                chunk = next;
+                index = 0;
+            }
+            else
+            {
+                ChunkBase* upper = link_new_chunk(chunk);
+                const size_t keep = ChunkCapacity / 2;
+                relocate_range(values(upper), values(chunk) + keep, ChunkCapacity - keep);
+                upper->count = ChunkCapacity - keep;
+                chunk->count = keep;
+                if (index > keep)
+                {
+                    chunk = upper;
+                    index -= keep;
+                }
+            }
+        }
+
+        Type* data = values(chunk);
+        for (size_t i = chunk->count; i > index; --i)
+        {
+            relocate(data + i, data + i - 1);
+        }
+        ::new (static_cast<void*>(data + index)) Type(std::move(value));
+        ++chunk->count;
+        ++size_;
+        return Iterator{ chunk, index };
+    }
+
+    Iterator erase(ConstIterator pos) noexcept
+    {
+        assert(!empty());
+        assert(pos.chunk_ != nullptr);
+
+        ChunkBase* prev = pos.chunk_;
+        ChunkBase* chunk = prev;
+        size_t index = pos.index_ + 1;
+        if (index >= chunk->count)
+        {
+            chunk = chunk->next_chunk;
+            index = 0;
+        }
+        assert(chunk != nullptr && index < chunk->count);
+
+        Type* data = values(chunk);
+        data[index].~Type();
+        for (size_t i = index + 1; i < chunk->count; ++i)
+        {
+            relocate(data + i - 1, data + i);
+        }
+        --chunk->count;
+        --size_;
+
+        if (chunk->count == 0)
+        {
+            assert(prev != chunk);
+
+            unlink_chunk_after(prev);
+            return Iterator{ prev->next_chunk, 0 };
+        }
+
+        ChunkBase* next = chunk->next_chunk;
+        if (chunk->count < ChunkCapacity / 2 && next != nullptr && chunk->count + next->count <= ChunkCapacity)
+        {
+            relocate_range(data + chunk->count, values(next), next->count);
+            chunk->count += next->count;
+            next->count = 0;
+            unlink_chunk_after(chunk);
+        }
+
+        if (index < chunk->count)
+        {
+            return Iterator{ chunk, index };
+        }
+        return Iterator{ chunk->next_chunk, 0 };
+    }
+
+    UnrolledLinkedList& operator=(const UnrolledLinkedList& rhs)
+    {
+        if (this != &rhs)
+        {
+            UnrolledLinkedList rhs_copy(ChunkAllocTraits::propagate_on_container_copy_assignment::value ? rhs.chunk_alloc_ : chunk_alloc_);
+            rhs_copy.assign(rhs.begin(), rhs.end());
+            swap_all(rhs_copy);
+        }
+        return *this;
+    }
+
+    UnrolledLinkedList& operator=(UnrolledLinkedList&& rhs) noexcept(
+        ChunkAllocTraits::propagate_on_container_move_assignment::value || ChunkAllocTraits::is_always_equal::value)
+    {
+        if (this != &rhs)
+        {
+            if constexpr (ChunkAllocTraits::propagate_on_container_move_assignment::value)
+            {
+                clear();
+                chunk_alloc_ = std::move(rhs.chunk_alloc_);
+                steal_chunks(rhs);
+            }
+            else if (ChunkAllocTraits::is_always_equal::value || chunk_alloc_ == rhs.chunk_alloc_)
+            {
+                clear();
+                steal_chunks(rhs);
+            }
+            else
+            {
+                assign(std::make_move_iterator(rhs.begin()), std::make_move_iterator(rhs.end()));
+                rhs.clear();
+            }
+        }
+        return *this;
+    }
+
+    void swap(UnrolledLinkedList& other) noexcept
+    {
+        if constexpr (ChunkAllocTraits::propagate_on_container_swap::value)
+        {
+            std::swap(other.chunk_alloc_, chunk_alloc_);
+        }
+        else
+        {
+            assert(other.chunk_alloc_ == chunk_alloc_);
+        }
+        std::swap(other.head_.next_chunk, head_.next_chunk);
+        std::swap(other.size_, size_);
+    }
+
+    [[nodiscard]] size_t size() const noexcept
+    {
+        return size_;
+    }
+
+    [[nodiscard]] bool empty() const noexcept
+    {
+        return size_ == 0;
+    }
+
+    [[nodiscard]] size_t chunk_count() const noexcept
+    {
+        size_t count = 0;
+        for (const ChunkBase* chunk = head_.next_chunk; chunk != nullptr; chunk = chunk->next_chunk)
+        {
+            ++count;
+        }
+        return count;
+    }
+
+    void push_front(const Type& value)
+    {
+        emplace_front(value);
+    }
+
+    void push_front(Type&& value)
+    {
+        emplace_front(std::move(value));
+    }
+
+    template <typename... Args>
+    reference emplace_front(Args&&... args)
+    {
+        return *emplace_after(cbefore_begin(), std::forward<Args>(args)...);
+    }
+
+    void clear() noexcept
+    {
+        while (head_.next_chunk)
+        {
+            ChunkBase* chunk = head_.next_chunk;
+            std::destroy_n(values(chunk), chunk->count);
+            chunk->count = 0;
+            unlink_chunk_after(&head_);
+        }
+        size_ = 0;
+    }
+
+    void pop_front() noexcept
+    {
+        assert(!empty());
+
+        erase(cbefore_begin());
+    }
+
+private:
+
+    ChunkBase head_;
+    size_t size_ = 0;
+    CUSTOM_LIST_NO_UNIQUE_ADDRESS ChunkAllocator chunk_alloc_;
+
+    static void relocate(Type* dst, Type* src) noexcept
+    {
+        ::new (static_cast<void*>(dst)) Type(std::move(*src));
+        src->~Type();
+    }
+
+    static void relocate_range(Type* dst, Type* src, size_t count) noexcept
+    {
+        for (size_t i = 0; i < count; ++i)
+        {
+            relocate(dst + i, src + i);
+        }
+    }
+
+    ChunkBase* link_new_chunk(ChunkBase* prev)
+    {
+        Chunk* chunk = ChunkAllocTraits::allocate(chunk_alloc_, 1);
+        ::new (static_cast<void*>(chunk)) Chunk;
+        chunk->next_chunk = prev->next_chunk;
+        prev->next_chunk = chunk;
+        return chunk;
+    }
+
+    void unlink_chunk_after(ChunkBase* prev) noexcept
+    {
+        Chunk* chunk = static_cast<Chunk*>(prev->next_chunk);
+        assert(chunk != nullptr && chunk->count == 0);
+
+        prev->next_chunk = chunk->next_chunk;
+        chunk->~Chunk();
+        ChunkAllocTraits::deallocate(chunk_alloc_, chunk, 1);
+    }
+
+    void swap_all(UnrolledLinkedList& other) noexcept
+    {
+        std::swap(other.chunk_alloc_, chunk_alloc_);
+        std::swap(other.head_.next_chunk, head_.next_chunk);
+        std::swap(other.size_, size_);
+    }
+
+    void steal_chunks(UnrolledLinkedList& other) noexcept
+    {
+        assert(head_.next_chunk == nullptr);
+
+        head_.next_chunk = std::exchange(other.head_.next_chunk, nullptr);
+        size_ = std::exchange(other.size_, 0);
+    }
+
+    // Fills chunks to capacity in order, so freshly built lists are as dense as possible.
+    template <typename InputIterator>
+    void assign(InputIterator from, InputIterator to)
+    {
+        UnrolledLinkedList tmp(chunk_alloc_);
+        ChunkBase* last = &tmp.head_;
+
+        while (from != to)
+        {
+            if (last == &tmp.head_ || last->count == ChunkCapacity)
+            {
+                last = tmp.link_new_chunk(last);
+            }
+            ::new (static_cast<void*>(values(last) + last->count)) Type(*from);
+            ++last->count;
+            ++tmp.size_;
+            ++from;
+        }
+        swap_all(tmp);
+    }
+};
+
+template <typename Type, size_t ChunkCapacity, typename Allocator>
+void swap(UnrolledLinkedList<Type, ChunkCapacity, Allocator>& lhs, UnrolledLinkedList<Type, ChunkCapacity, Allocator>& rhs) noexcept
+{
+    lhs.swap(rhs);
+}
+
+template <typename Type, size_t ChunkCapacity, typename Allocator>
+bool operator==(const UnrolledLinkedList<Type, ChunkCapacity, Allocator>& lhs, const UnrolledLinkedList<Type, ChunkCapacity, Allocator>& rhs)
+{
+    return &lhs == &rhs || (lhs.size() == rhs.size() && std::equal(lhs.begin(), lhs.end(), rhs.begin()));
+}
+
+template <typename Type, size_t ChunkCapacity, typename Allocator>
+bool operator!=(const UnrolledLinkedList<Type, ChunkCapacity, Allocator>& lhs, const UnrolledLinkedList<Type, ChunkCapacity, Allocator>& rhs)
+{
+    return !(lhs == rhs);
+}
+
+template <typename Type, size_t ChunkCapacity, typename Allocator>
+bool operator<(const UnrolledLinkedList<Type, ChunkCapacity, Allocator>& lhs, const UnrolledLinkedList<Type, ChunkCapacity, Allocator>& rhs)
+{
+    return std::lexicographical_compare(lhs.begin(), lhs.end(), rhs.begin(), rhs.end());
+}
+
+template <typename Type, size_t ChunkCapacity, typename Allocator>
+bool operator<=(const UnrolledLinkedList<Type, ChunkCapacity, Allocator>& lhs, const UnrolledLinkedList<Type, ChunkCapacity, Allocator>& rhs)
+{
+    return !(rhs < lhs);
+}
+
+template <typename Type, size_t ChunkCapacity, typename Allocator>
+bool operator>(const UnrolledLinkedList<Type, ChunkCapacity, Allocator>& lhs, const UnrolledLinkedList<Type, ChunkCapacity, Allocator>& rhs)
+{
+    return rhs < lhs;
+}
+
+template <typename Type, size_t ChunkCapacity, typename Allocator>
+bool operator>=(const UnrolledLinkedList<Type, ChunkCapacity, Allocator>& lhs, const UnrolledLinkedList<Type, ChunkCapacity, Allocator>& rhs)
+{
+    return !(lhs < rhs);
+}